@@ -673,9 +673,7 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
     DDBuffer<gmx::RVec> rvecBuffer2;
 
     /* Communication buffers for local redistribution */
-    /**< Charge group flag comm. buffers */
-    std::array<std::vector<int>, DIM * 2> cggl_flag;
-    /**< Charge group center comm. buffers */
+    /**< Global index, move flag, group center and state comm. buffers */
     std::array<std::vector<gmx::RVec>, DIM * 2> cgcm_state;
 
     /* Cell sizes for dynamic load balancing */
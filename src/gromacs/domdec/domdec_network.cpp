@@ -68,6 +68,14 @@
  *
  * Moves in the dimension indexed by ddDimensionIndex, either forward
  * (direction=dddirFoward) or backward (direction=dddirBackward).
+ *
+ * Note that with thread-MPI the transfer is a single direct copy from
+ * the send buffer of one rank to the receive buffer of the other,
+ * which for the halo coordinates is the coordinate array itself when
+ * receiving in place. Library MPI implementations use shared-memory
+ * transports within a node. So a dedicated intra-node path would
+ * only save the handshake, which it would need itself to know that
+ * the data of the neighbor is ready.
  */
 template<typename T>
 static void ddSendrecv(const struct gmx_domdec_t* dd,
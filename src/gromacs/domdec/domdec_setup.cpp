@@ -49,7 +49,9 @@
 #include <cinttypes>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 
+#include <algorithm>
 #include <filesystem>
 #include <numeric>
 #include <string>
@@ -542,8 +544,19 @@ static float comm_cost_est(real               limit,
     return 3 * natoms * (comm_vol + cost_pbcdx) + comm_pme;
 }
 
+//! A candidate DD grid with its estimated communication cost
+struct DDGridCandidate
+{
+    //! The estimated cost
+    float cost;
+    //! The number of domains along each dimension
+    gmx::IVec numDomains;
+};
+
 /*! \brief Assign penalty factors to possible domain decompositions,
- * based on the estimated communication costs. */
+ * based on the estimated communication costs.
+ *
+ * All valid decompositions are appended to \p candidates. */
 static void assign_factors(const real         limit,
                            const real         cutoff,
                            const matrix       box,
@@ -555,20 +568,17 @@ static void assign_factors(const real         limit,
                            int                ndiv,
                            const int*         div,
                            const int*         mdiv,
-                           gmx::IVec*         irTryPtr,
-                           gmx::IVec*         opt)
+                           gmx::IVec*                    irTryPtr,
+                           std::vector<DDGridCandidate>* candidates)
 {
     gmx::IVec& ir_try = *irTryPtr;
 
     if (ndiv == 0)
     {
-
         const float ce = comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, ir_try);
-        if (ce >= 0
-            && ((*opt)[XX] == 0
-                || ce < comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, *opt)))
+        if (ce >= 0)
         {
-            *opt = ir_try;
+            candidates->push_back({ ce, ir_try });
         }
 
         return;
@@ -592,8 +602,19 @@ static void assign_factors(const real         limit,
             }
 
             /* recurse */
-            assign_factors(
-                    limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, ndiv - 1, div + 1, mdiv + 1, irTryPtr, opt);
+            assign_factors(limit,
+                           cutoff,
+                           box,
+                           ddbox,
+                           natoms,
+                           ir,
+                           pbcdxr,
+                           npme,
+                           ndiv - 1,
+                           div + 1,
+                           mdiv + 1,
+                           irTryPtr,
+                           candidates);
 
             for (int i = 0; i < mdiv[0] - x - y; i++)
             {
@@ -695,8 +716,8 @@ static gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
     std::vector<int> mdiv;
     factorize(numPPRanks, &div, &mdiv);
 
-    gmx::IVec itry       = { 1, 1, 1 };
-    gmx::IVec numDomains = { 0, 0, 0 };
+    gmx::IVec                    itry = { 1, 1, 1 };
+    std::vector<DDGridCandidate> candidates;
     assign_factors(cellSizeLimit,
                    systemInfo.cutoff,
                    box,
@@ -709,9 +730,63 @@ static gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
                    div.data(),
                    mdiv.data(),
                    &itry,
-                   &numDomains);
+                   &candidates);
+
+    if (candidates.empty())
+    {
+        return { 0, 0, 0 };
+    }
+
+    /* Sort on cost, the stable sort keeps the enumeration order for equal costs */
+    std::stable_sort(candidates.begin(),
+                     candidates.end(),
+                     [](const DDGridCandidate& a, const DDGridCandidate& b) {
+                         return a.cost < b.cost;
+                     });
+
+    /* Report the best candidates, so users can try alternatives with mdrun -dd */
+    constexpr int c_maxNumCandidatesToReport = 5;
+    const int     numCandidatesToReport =
+            std::min(c_maxNumCandidatesToReport, static_cast<int>(candidates.size()));
+    if (numCandidatesToReport > 1)
+    {
+        std::string text = "The DD grids with the lowest estimated communication cost are:";
+        for (int i = 0; i < numCandidatesToReport; i++)
+        {
+            const DDGridCandidate& candidate = candidates[i];
+            text += gmx::formatString("\n  %d x %d x %d, relative cost %.2f",
+                                      candidate.numDomains[XX],
+                                      candidate.numDomains[YY],
+                                      candidate.numDomains[ZZ],
+                                      candidates[0].cost > 0 ? candidate.cost / candidates[0].cost
+                                                             : 1.0F);
+        }
+        GMX_LOG(mdlog.info).appendText(text);
+    }
+
+    /* Allow selecting a different candidate, for benchmarking the actual
+     * performance of the grids that the cost estimate considers close.
+     */
+    int candidateIndex = 0;
+    if (const char* env = getenv("GMX_DD_GRID_CANDIDATE"))
+    {
+        candidateIndex = std::max(0, std::atoi(env));
+        if (candidateIndex >= static_cast<int>(candidates.size()))
+        {
+            GMX_LOG(mdlog.warning)
+                    .appendTextFormatted(
+                            "GMX_DD_GRID_CANDIDATE=%d is out of range, there are %zu candidate DD "
+                            "grids, using the last one",
+                            candidateIndex,
+                            candidates.size());
+            candidateIndex = static_cast<int>(candidates.size()) - 1;
+        }
+        GMX_LOG(mdlog.info)
+                .appendTextFormatted("Using DD grid candidate %d as set by GMX_DD_GRID_CANDIDATE",
+                                     candidateIndex);
+    }
 
-    return numDomains;
+    return candidates[candidateIndex].numDomains;
 }
 
 real getDDGridSetupCellSizeLimit(const gmx::MDLogger& mdlog,
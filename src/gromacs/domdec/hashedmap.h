@@ -129,6 +129,9 @@ public:
     /*! \brief Returns the number of buckets, i.e. the number of possible hashes */
     int bucket_count() const { return bitMask_ + 1; }
 
+    /*! \brief Returns the number of table entries, the buckets plus linked entries */
+    int tableSize() const { return static_cast<int>(table_.size()); }
+
 private:
     /*! \brief Inserts or assigns a key and value
      *
@@ -234,7 +237,19 @@ public:
                 if (ind_prev >= 0)
                 {
                     table_[ind_prev].next = table_[ind].next;
-
+                }
+                else if (table_[ind].next >= 0)
+                {
+                    /* This is the head of a list with linked entries.
+                     * Move the first linked entry to the head, so the rest
+                     * of the list stays reachable, and free that entry instead.
+                     */
+                    const int indNext = table_[ind].next;
+                    table_[ind]       = table_[indNext];
+                    ind               = indNext;
+                }
+                if (ind >= bucket_count())
+                {
                     /* This index is a linked entry, so we free an entry.
                      * Check if we are creating the first empty space.
                      */
@@ -78,10 +78,10 @@
 #include "domdec_internal.h"
 #include "utility.h"
 
-/* The size per charge group of the cggl_flag buffer in gmx_domdec_comm_t */
+/* The number of integers per atom or group for its global index and move flag */
 static constexpr int DD_CGIBS = 2;
 
-/* The flags for the cggl_flag buffer in gmx_domdec_comm_t */
+/* The flags stored along with the global index in the cgcm_state buffers */
 
 /* The lower 16 bits are reserved for the charge group size */
 static constexpr int DD_FLAG_NRCG = 65535;
@@ -98,6 +98,44 @@ static inline int DD_FLAG_BW(int d)
     return 1 << (16 + d * 2 + 1);
 }
 
+/*! \brief The number of RVec entries per atom or group in the cgcm_state buffers
+ *
+ * The first entry stores the global atom index and move flag as integers,
+ * the second the center of geometry, followed by \p nvec state vectors.
+ * Storing the integers in the same buffer as the state allows sending
+ * everything in a single message per pulse.
+ */
+static int cgcmStateStride(int nvec)
+{
+    return 2 + nvec;
+}
+
+static_assert(sizeof(gmx::RVec) >= DD_CGIBS * sizeof(int),
+              "The global index and flag should fit in one RVec buffer entry");
+
+//! Stores the global atom index and move flag in an RVec buffer entry
+static void setGlobalIndexAndFlag(gmx::RVec* entry, int globalAtomIndex, int flag)
+{
+    const int data[DD_CGIBS] = { globalAtomIndex, flag };
+    std::memcpy(entry->as_vec(), data, sizeof(data));
+}
+
+//! Returns the global atom index stored in an RVec buffer entry
+static int getGlobalIndex(const gmx::RVec& entry)
+{
+    int data[DD_CGIBS];
+    std::memcpy(data, entry.as_vec(), sizeof(data));
+    return data[0];
+}
+
+//! Returns the move flag stored in an RVec buffer entry
+static int getFlag(const gmx::RVec& entry)
+{
+    int data[DD_CGIBS];
+    std::memcpy(data, entry.as_vec(), sizeof(data));
+    return data[1];
+}
+
 static void copyMovedAtomsToBufferPerAtom(gmx::ArrayRef<const int> move,
                                           int                      nvec,
                                           int                      vec,
@@ -112,8 +150,8 @@ static void copyMovedAtomsToBufferPerAtom(gmx::ArrayRef<const int> move,
         const int m = move[i];
         if (m >= 0)
         {
-            /* Copy to the communication buffer */
-            pos_vec[m] += 1 + vec;
+            /* Copy to the communication buffer, skip the index/flag and COG entries */
+            pos_vec[m] += 2 + vec;
             copy_rvec(src[i], comm->cgcm_state[m][pos_vec[m]++]);
             pos_vec[m] += nvec - vec - 1;
         }
@@ -137,8 +175,8 @@ static void copyMovedUpdateGroupCogs(gmx::ArrayRef<const int>       move,
             const gmx::RVec& cog =
                     (comm->systemInfo.useUpdateGroups ? comm->updateGroupsCog->cogForAtom(g)
                                                       : coordinates[g]);
-            copy_rvec(cog, comm->cgcm_state[m][pos_vec[m]]);
-            pos_vec[m] += 1 + nvec;
+            copy_rvec(cog, comm->cgcm_state[m][pos_vec[m] + 1]);
+            pos_vec[m] += cgcmStateStride(nvec);
         }
     }
 }
@@ -702,25 +740,13 @@ void dd_redistribute_cg(FILE*         fplog,
         {
             // The value in move[cg] was computed by computeMoveFlags
             // and describes how this atom should move between domains.
-            const int flag = move[cg] & ~DD_FLAG_NRCG;
-            // mc contains 4 bits that tell which is the first
-            // dimension (bit 1,2,3) that the group needs to be moved
-            // along, and in which direction (bit 0; not set for fw
-            // and set for bw). However the value is always in
-            // the range [0,6)
-            const int mc = move[cg] & DD_FLAG_NRCG;
-            move[cg]     = mc;
-
-            std::vector<int>& cggl_flag = comm->cggl_flag[mc];
-
-            /* TODO: See if we can use push_back instead */
-            if ((nat[mc] + 1) * DD_CGIBS > gmx::Index(cggl_flag.size()))
-            {
-                cggl_flag.resize((nat[mc] + 1) * DD_CGIBS);
-            }
-            cggl_flag[nat[mc] * DD_CGIBS]     = dd->globalAtomIndices[cg];
-            cggl_flag[nat[mc] * DD_CGIBS + 1] = flag;
-            nat[mc]++;
+            // The bits in DD_FLAG_NRCG give the send buffer index,
+            // which is twice the first dimension the atom moves along,
+            // plus one when moving backward, so always in the range
+            // [0,6). The other bits are the move flags, which are sent
+            // together with the global atom index in the leading RVec
+            // entry of each atom in the send buffer.
+            nat[move[cg] & DD_FLAG_NRCG]++;
         }
     }
 
@@ -743,16 +769,38 @@ void dd_redistribute_cg(FILE*         fplog,
         nvec++;
     }
 
+    const int stride = cgcmStateStride(nvec);
+
     /* Make sure the communication buffers are large enough */
     for (int mc = 0; mc < dd->ndim * 2; mc++)
     {
-        size_t nvr = nat[mc] * (1 + nvec);
+        size_t nvr = nat[mc] * stride;
         if (nvr > comm->cgcm_state[mc].size())
         {
             comm->cgcm_state[mc].resize(nvr);
         }
     }
 
+    /* Store the global indices and flags and replace the move flags
+     * by the index of the buffer the atom is sent from.
+     */
+    {
+        int pos[DIM * 2] = { 0 };
+        for (int cg = 0; cg < dd->numHomeAtoms; cg++)
+        {
+            if (move[cg] >= 0)
+            {
+                const int flag = move[cg] & ~DD_FLAG_NRCG;
+                const int mc   = move[cg] & DD_FLAG_NRCG;
+                move[cg]       = mc;
+
+                setGlobalIndexAndFlag(
+                        &comm->cgcm_state[mc][pos[mc]], dd->globalAtomIndices[cg], flag);
+                pos[mc] += stride;
+            }
+        }
+    }
+
     /* With update groups we send over their COGs.
      * Without update groups we send the moved atom coordinates
      * over twice. This is so the code further down can be used
@@ -778,9 +826,6 @@ void dd_redistribute_cg(FILE*         fplog,
     /* Now we can remove the excess global atom indices from the list */
     dd->globalAtomIndices.resize(dd->numHomeAtoms);
 
-    /* We reuse the intBuffer without reacquiring since we are in the same scope */
-    DDBufferAccess<int>& flagBuffer = moveBuffer;
-
     gmx::ArrayRef<const gmx::AtomInfoWithinMoleculeBlock> atomInfoForEachMoleculeBlock =
             fr->atomInfoForEachMoleculeBlock;
 
@@ -808,21 +853,11 @@ void dd_redistribute_cg(FILE*         fplog,
                        gmx::arrayRefFromArray(&nat[cdd], 1),
                        gmx::arrayRefFromArray(&atomCountToReceive, 1));
 
-            flagBuffer.resize((totalAtomsReceived + atomCountToReceive) * DD_CGIBS);
-
-            /* Communicate the charge group indices, sizes and flags */
-            ddSendrecv(dd,
-                       d,
-                       dir,
-                       gmx::arrayRefFromArray(comm->cggl_flag[cdd].data(), nat[cdd] * DD_CGIBS),
-                       gmx::arrayRefFromArray(flagBuffer.buffer.data() + totalAtomsReceived * DD_CGIBS,
-                                              atomCountToReceive * DD_CGIBS));
-
-            const int nvs = nat[cdd] * (1 + nvec);
-            const int i   = atomCountToReceive * (1 + nvec);
+            const int nvs = nat[cdd] * stride;
+            const int i   = atomCountToReceive * stride;
             rvecBuffer.resize(nvr + i);
 
-            /* Communicate cgcm and state */
+            /* Communicate the global indices, flags, cgcm and state in one message */
             ddSendrecv(dd,
                        d,
                        dir,
@@ -839,8 +874,8 @@ void dd_redistribute_cg(FILE*         fplog,
         for (int cg = 0; cg < totalAtomsReceived; cg++)
         {
             /* Extract the move flags and COG for the charge or update group */
-            int              flag = flagBuffer.buffer[cg * DD_CGIBS + 1];
-            const gmx::RVec& cog  = rvecBuffer.buffer[buf_pos];
+            int              flag = getFlag(rvecBuffer.buffer[buf_pos]);
+            const gmx::RVec& cog  = rvecBuffer.buffer[buf_pos + 1];
 
             if (dim >= npbcdim && dd->numCells[dim] > 2)
             {
@@ -906,7 +941,9 @@ void dd_redistribute_cg(FILE*         fplog,
                                 flag |= DD_FLAG_BW(d2);
                             }
 
-                            flagBuffer.buffer[cg * DD_CGIBS + 1] = flag;
+                            setGlobalIndexAndFlag(&rvecBuffer.buffer[buf_pos],
+                                                  getGlobalIndex(rvecBuffer.buffer[buf_pos]),
+                                                  flag);
                         }
                     }
                     /* Set to which neighboring cell this cg should go */
@@ -931,10 +968,10 @@ void dd_redistribute_cg(FILE*         fplog,
             if (mc == -1)
             {
                 /* Set the global charge group index and size */
-                const int globalAtomIndex = flagBuffer.buffer[cg * DD_CGIBS];
+                const int globalAtomIndex = getGlobalIndex(rvecBuffer.buffer[buf_pos]);
                 dd->globalAtomIndices.push_back(globalAtomIndex);
-                /* Skip the COG entry in the buffer */
-                buf_pos++;
+                /* Skip the index/flag and COG entries in the buffer */
+                buf_pos += 2;
 
                 /* Set the cginfo */
                 fr->atomInfo[home_pos_at] = ddGetAtomInfo(atomInfoForEachMoleculeBlock, globalAtomIndex);
@@ -956,24 +993,17 @@ void dd_redistribute_cg(FILE*         fplog,
             }
             else
             {
-                /* Reallocate the buffers if necessary  */
-                if ((nat[mc] + 1) * DD_CGIBS > gmx::Index(comm->cggl_flag[mc].size()))
-                {
-                    comm->cggl_flag[mc].resize((nat[mc] + 1) * DD_CGIBS);
-                }
-                size_t nvr = nat[mc] * (1 + nvec);
-                if (nvr + 1 + nvec > comm->cgcm_state[mc].size())
+                /* Reallocate the buffer if necessary  */
+                size_t nvr = nat[mc] * stride;
+                if (nvr + stride > comm->cgcm_state[mc].size())
                 {
-                    comm->cgcm_state[mc].resize(nvr + 1 + nvec);
+                    comm->cgcm_state[mc].resize(nvr + stride);
                 }
-                /* Copy from the receive to the send buffers */
-                memcpy(comm->cggl_flag[mc].data() + nat[mc] * DD_CGIBS,
-                       flagBuffer.buffer.data() + cg * DD_CGIBS,
-                       DD_CGIBS * sizeof(int));
+                /* Copy from the receive to the send buffer */
                 memcpy(comm->cgcm_state[mc][nvr],
                        rvecBuffer.buffer.data() + buf_pos,
-                       (1 + nvec) * sizeof(rvec));
-                buf_pos += 1 + nvec;
+                       stride * sizeof(rvec));
+                buf_pos += stride;
                 nat[mc]++;
             }
         }
@@ -168,6 +168,37 @@ TEST(HashedMap, LinkedEntries)
     checkFinds(map, 3 + 2 * largePowerOf2, 'c');
 }
 
+// Check that erasing the first entry of a linked list keeps the other entries
+TEST(HashedMap, ErasesHeadOfLinkedEntries)
+{
+    gmx::HashedMap<char> map(20);
+
+    const int largePowerOf2 = 2048;
+
+    map.insert(3 + 0 * largePowerOf2, 'a');
+    map.insert(3 + 1 * largePowerOf2, 'b');
+    map.insert(3 + 2 * largePowerOf2, 'c');
+
+    map.erase(3 + 0 * largePowerOf2);
+
+    checkDoesNotFind(map, 3 + 0 * largePowerOf2);
+    checkFinds(map, 3 + 1 * largePowerOf2, 'b');
+    checkFinds(map, 3 + 2 * largePowerOf2, 'c');
+    EXPECT_EQ(map.size(), 2);
+
+    // Assigning to a present key should not add a duplicate entry
+    map.insert_or_assign(3 + 2 * largePowerOf2, 'd');
+    checkFinds(map, 3 + 2 * largePowerOf2, 'd');
+    EXPECT_EQ(map.size(), 2);
+
+    // The freed linked entry should be reused, so the table should not grow
+    const int tableSize = map.tableSize();
+    map.insert(3 + 3 * largePowerOf2, 'e');
+    checkFinds(map, 3 + 3 * largePowerOf2, 'e');
+    EXPECT_EQ(map.size(), 3);
+    EXPECT_EQ(map.tableSize(), tableSize);
+}
+
 // HashedMap only throws in debug mode, so only test in debug mode
 #ifndef NDEBUG
 
@@ -47,6 +47,7 @@
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
+#include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
@@ -99,6 +100,10 @@ struct ener_file
     t_fileio*  fio;
     int        framenr;
     real       frametime;
+    int        nreadTerm;              /* The number of entries in bReadTerm */
+    gmx_bool*  bReadTerm;              /* Which terms to read, all terms when NULL */
+    gmx_bool   bSkipBlocks;            /* Whether to skip the data blocks */
+    gmx_bool   bSkipOutsideTimeWindow; /* Whether to skip data of frames outside -b/-e/-dt */
 };
 
 static void enxsubblock_init(t_enxsubblock* sb)
@@ -770,6 +775,8 @@ void close_enx(ener_file_t ef)
         // Nothing to do
         return;
     }
+    sfree(ef->bReadTerm);
+    ef->bReadTerm = nullptr;
     if (gmx_fio_close(ef->fio) != 0)
     {
         gmx_file(
@@ -893,6 +900,52 @@ t_fileio* enx_file_pointer(const ener_file* ef)
     return ef->fio;
 }
 
+void set_enx_read_selection(ener_file_t     ef,
+                            int             nre,
+                            const gmx_bool* bReadTerm,
+                            gmx_bool        bReadBlocks,
+                            gmx_bool        bSkipOutsideTimeWindow)
+{
+    sfree(ef->bReadTerm);
+    ef->bReadTerm = nullptr;
+    ef->nreadTerm = 0;
+    if (bReadTerm != nullptr)
+    {
+        snew(ef->bReadTerm, nre);
+        std::copy(bReadTerm, bReadTerm + nre, ef->bReadTerm);
+        ef->nreadTerm = nre;
+    }
+    ef->bSkipBlocks            = !bReadBlocks;
+    ef->bSkipOutsideTimeWindow = bSkipOutsideTimeWindow;
+}
+
+/* Moves the file position \p nbytes ahead, returns whether this succeeded */
+static gmx_bool enx_skip_data(ener_file_t ef, gmx_off_t nbytes)
+{
+    if (nbytes == 0)
+    {
+        return TRUE;
+    }
+
+    return gmx_fio_seek(ef->fio, gmx_fio_ftell(ef->fio) + nbytes) == 0;
+}
+
+/* Returns the number of bytes of subblock \p sb in the file, or -1 when
+ * the size depends on the contents */
+static gmx_off_t enx_subblock_file_size(const t_enxsubblock* sb)
+{
+    /* XDR stores chars and ints in 4 bytes */
+    switch (sb->type)
+    {
+        case XdrDataType::Float: return sb->nr * static_cast<gmx_off_t>(sizeof(float));
+        case XdrDataType::Double: return sb->nr * static_cast<gmx_off_t>(sizeof(double));
+        case XdrDataType::Int: return sb->nr * static_cast<gmx_off_t>(4);
+        case XdrDataType::Int64: return sb->nr * static_cast<gmx_off_t>(8);
+        case XdrDataType::Char: return sb->nr * static_cast<gmx_off_t>(4);
+        default: return -1;
+    }
+}
+
 static void convert_full_sums(ener_old_t* ener_old, t_enxframe* fr)
 {
     int    nstep_all;
@@ -1039,14 +1092,33 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         fr->e_alloc = fr->nre;
     }
 
+    /* With a read selection, the data of unselected terms and blocks is skipped.
+     * Old format files need all terms for converting the sums.
+     */
+    const gmx_bool bSkipFrameData = bRead && ef->bSkipOutsideTimeWindow && check_times(fr->t) != 0;
+    const gmx_bool bSelectTerms =
+            bRead && (bSkipFrameData || ef->bReadTerm != nullptr) && !ef->eo.bOldFileOpen;
+    const gmx_bool bHaveSums = (file_version == 1 || (bRead && fr->nsum > 0) || fr->nsum > 1);
+    const gmx_off_t termSize = (1 + (bHaveSums ? (file_version == 1 ? 3 : 2) : 0))
+                               * (gmx_fio_is_double(ef->fio) ? sizeof(double) : sizeof(float));
+    gmx_off_t bytesToSkip = 0;
+
     for (i = 0; i < fr->nre; i++)
     {
+        if (bSelectTerms && (bSkipFrameData || (i < ef->nreadTerm && !ef->bReadTerm[i])))
+        {
+            bytesToSkip += termSize;
+            continue;
+        }
+        bOK         = bOK && enx_skip_data(ef, bytesToSkip);
+        bytesToSkip = 0;
+
         bOK = bOK && gmx_fio_do_real(ef->fio, fr->ener[i].e);
 
         /* Do not store sums of length 1,
          * since this does not add information.
          */
-        if (file_version == 1 || (bRead && fr->nsum > 0) || fr->nsum > 1)
+        if (bHaveSums)
         {
             tmp1 = fr->ener[i].eav;
             bOK  = bOK && gmx_fio_do_real(ef->fio, tmp1);
@@ -1081,6 +1153,7 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         convert_full_sums(&(ef->eo), fr);
     }
     /* read the blocks */
+    const gmx_bool bSkipBlocks = bRead && (bSkipFrameData || ef->bSkipBlocks);
     for (b = 0; b < fr->nblock; b++)
     {
         /* now read the subblocks. */
@@ -1091,6 +1164,14 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         {
             t_enxsubblock* sub = &(fr->block[b].sub[i]); /* shortcut */
 
+            if (bSkipBlocks && enx_subblock_file_size(sub) >= 0)
+            {
+                bytesToSkip += enx_subblock_file_size(sub);
+                continue;
+            }
+            bOK         = bOK && enx_skip_data(ef, bytesToSkip);
+            bytesToSkip = 0;
+
             if (bRead)
             {
                 enxsubblock_alloc(sub);
@@ -1123,6 +1204,12 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
             bOK = bOK && bOK1;
         }
     }
+    bOK = bOK && enx_skip_data(ef, bytesToSkip);
+    if (bSkipBlocks)
+    {
+        /* Skipped blocks contain no valid data */
+        fr->nblock = 0;
+    }
 
     if (!bRead)
     {
@@ -178,6 +178,19 @@ void free_enxnms(int n, gmx_enxnm_t* nms);
 gmx_bool do_enx(ener_file_t ef, t_enxframe* fr);
 /* Reads enx_frames, memory in fr is (re)allocated if necessary */
 
+void set_enx_read_selection(ener_file_t     ef,
+                            int             nre,
+                            const gmx_bool* bReadTerm,
+                            gmx_bool        bReadBlocks,
+                            gmx_bool        bSkipOutsideTimeWindow);
+/* Restricts what do_enx reads from ef. Only the energy terms with bReadTerm
+ * set are read, all nre terms when bReadTerm is NULL. The extra data blocks
+ * are only read with bReadBlocks. With bSkipOutsideTimeWindow, no energies
+ * or blocks are read for frames that check_times() rejects. The data that is
+ * not read is skipped without decoding, so the corresponding values in the
+ * frame are not valid, and frames without their blocks have nblock=0.
+ */
+
 void get_enx_state(const std::filesystem::path& fn,
                    real                         t,
                    const SimulationGroups&      groups,
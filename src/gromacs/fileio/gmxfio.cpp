@@ -39,6 +39,7 @@
 
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include <mutex>
@@ -53,6 +54,8 @@
 #    include <io.h>
 #endif
 #ifdef HAVE_UNISTD_H
+#    include <sys/mman.h>
+#    include <sys/stat.h>
 #    include <unistd.h>
 #endif
 
@@ -95,6 +98,70 @@ using Lock = std::lock_guard<std::mutex>;
  *
  ******************************************************************/
 
+/* Maps a file that is opened for reading only into memory, so its data can
+ * be decoded straight from the page cache without going through stdio.
+ * Only done for uncompressed binary trajectories, where all frame data
+ * consists of plain XDR reals, and only when requested with
+ * GMX_TRAJECTORY_MMAP, since accessing pages of a file that another process
+ * truncates raises SIGBUS. When mapping is not done, all reading goes
+ * through the stdio/XDR path as before.
+ */
+static void gmx_fio_map_for_reading(t_fileio* fio)
+{
+    fio->mappedData = nullptr;
+    fio->mappedSize = 0;
+#ifdef HAVE_UNISTD_H
+    if (fio->iFTP != efTRR || std::getenv("GMX_TRAJECTORY_MMAP") == nullptr)
+    {
+        return;
+    }
+    const int   fd = fileno(fio->fp);
+    struct stat fileStatus;
+    if (fd < 0 || fstat(fd, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode)
+        || fileStatus.st_size <= 0)
+    {
+        return;
+    }
+    void* mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return;
+    }
+    posix_madvise(mapping, fileStatus.st_size, POSIX_MADV_SEQUENTIAL);
+    fio->mappedData = static_cast<const unsigned char*>(mapping);
+    fio->mappedSize = fileStatus.st_size;
+#endif
+}
+
+static void gmx_fio_unmap(t_fileio* fio)
+{
+#ifdef HAVE_UNISTD_H
+    if (fio->mappedData != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(fio->mappedData), fio->mappedSize);
+    }
+#endif
+    fio->mappedData = nullptr;
+    fio->mappedSize = 0;
+}
+
+bool gmx_fio_mapped_range_is_readable(t_fileio* fio, gmx_off_t end)
+{
+    if (fio->mappedData == nullptr || end > fio->mappedSize)
+    {
+        return false;
+    }
+#ifdef HAVE_UNISTD_H
+    /* The file can have been truncated since it was mapped, in which case
+     * accessing the pages beyond the new end of the file raises SIGBUS.
+     */
+    struct stat fileStatus;
+    return fstat(fileno(fio->fp), &fileStatus) == 0 && end <= fileStatus.st_size;
+#else
+    return false;
+#endif
+}
+
 static int gmx_fio_int_flush(t_fileio* fio)
 {
     int rc = 0;
@@ -331,6 +398,11 @@ t_fileio* gmx_fio_open(const std::filesystem::path& fn, const char* mode)
             xdrstdio_create(fio->xdr, fio->fp, fio->xdrmode);
         }
 
+        if (bRead)
+        {
+            gmx_fio_map_for_reading(fio);
+        }
+
         /* for appending seek to end of file to make sure ftell gives correct position
          * important for checkpointing */
         if (newmode[0] == 'a')
@@ -356,6 +428,8 @@ static int gmx_fio_close_locked(t_fileio* fio)
 {
     int rc = 0;
 
+    gmx_fio_unmap(fio);
+
     if (fio->xdr != nullptr)
     {
         xdr_destroy(fio->xdr);
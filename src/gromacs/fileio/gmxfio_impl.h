@@ -56,17 +56,20 @@
 #include "thread_mpi/lock.h"
 
 #include "gromacs/fileio/xdrf.h"
+#include "gromacs/utility/futil.h"
 
 struct t_fileio
 {
-    FILE*    fp;                   /* the file pointer */
-    gmx_bool bRead,                /* the file is open for reading */
-            bDouble,               /* write doubles instead of floats */
-            bReadWrite;            /* the file is open for reading and writing */
-    std::filesystem::path fn;      /* the file name */
-    XDR*                  xdr;     /* the xdr data pointer */
-    enum xdr_op           xdrmode; /* the xdr mode */
-    int                   iFTP;    /* the file type identifier */
+    FILE*    fp;                      /* the file pointer */
+    gmx_bool bRead,                   /* the file is open for reading */
+            bDouble,                  /* write doubles instead of floats */
+            bReadWrite;               /* the file is open for reading and writing */
+    std::filesystem::path fn;         /* the file name */
+    XDR*                  xdr;        /* the xdr data pointer */
+    enum xdr_op           xdrmode;    /* the xdr mode */
+    int                   iFTP;       /* the file type identifier */
+    const unsigned char*  mappedData; /* read-only memory map of the file, or nullptr */
+    gmx_off_t             mappedSize; /* the size of the file when it was mapped */
 
     t_fileio *next, *prev; /* next and previous file pointers in the
                               linked list */
@@ -80,5 +83,8 @@ struct t_fileio
 void gmx_fio_lock(t_fileio* fio);
 /** unlock the mutex associated with a fio  */
 void gmx_fio_unlock(t_fileio* fio);
+/** return whether the mapped data of fio up to byte end can be accessed,
+ * i.e. it lies within the map and the file has not been truncated below it */
+bool gmx_fio_mapped_range_is_readable(t_fileio* fio, gmx_off_t end);
 
 #endif
@@ -36,6 +36,7 @@
 #include "gmxfio_xdr.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 
@@ -755,10 +756,89 @@ gmx_bool gmx_fio_ndoe_ushort(t_fileio* fio, unsigned short* item, int n, const c
 }
 
 
+/* Returns the XDR (big-endian) float starting at \p data */
+static float decode_xdr_float(const unsigned char* data)
+{
+    const uint32_t bits = (uint32_t{ data[0] } << 24) | (uint32_t{ data[1] } << 16)
+                          | (uint32_t{ data[2] } << 8) | uint32_t{ data[3] };
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Returns the XDR (big-endian) double starting at \p data */
+static double decode_xdr_double(const unsigned char* data)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        bits = (bits << 8) | data[i];
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Decodes \p n rvecs at the current file position straight from the memory
+ * map of the file into \p item, or skips them when \p item is nullptr, and
+ * advances the file position past them. Returns false, without reading
+ * anything, when the data does not lie within the mapped range, e.g. because
+ * the file has grown since it was opened, or the file has been truncated
+ * since. Otherwise \p bOK tells whether the file position could be advanced.
+ */
+static bool read_mapped_rvecs(t_fileio* fio, rvec* item, int n, gmx_bool* bOK)
+{
+    const gmx_off_t position = gmx_ftell(fio->fp);
+    const gmx_off_t elementSize =
+            static_cast<gmx_off_t>(fio->bDouble ? sizeof(double) : sizeof(float));
+    const gmx_off_t numBytes = static_cast<gmx_off_t>(n) * DIM * elementSize;
+    if (position < 0 || !gmx_fio_mapped_range_is_readable(fio, position + numBytes))
+    {
+        return false;
+    }
+
+    const unsigned char* data = fio->mappedData + position;
+    if (item == nullptr)
+    {
+        // Nothing to decode, only skip the data
+    }
+    else if (fio->bDouble)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            for (int m = 0; m < DIM; m++)
+            {
+                item[i][m] = decode_xdr_double(data);
+                data += sizeof(double);
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < n; i++)
+        {
+            for (int m = 0; m < DIM; m++)
+            {
+                item[i][m] = decode_xdr_float(data);
+                data += sizeof(float);
+            }
+        }
+    }
+
+    *bOK = (gmx_fseek(fio->fp, position + numBytes, SEEK_SET) == 0);
+
+    return true;
+}
+
 gmx_bool gmx_fio_ndoe_rvec(t_fileio* fio, rvec* item, int n, const char* desc, const char* srcfile, int line)
 {
     gmx_bool ret = TRUE;
     gmx_fio_lock(fio);
+    if (fio->bRead && fio->mappedData != nullptr && read_mapped_rvecs(fio, item, n, &ret))
+    {
+        gmx_fio_unlock(fio);
+        return ret;
+    }
     ret = ret && do_xdr(fio, item, n, InputOutputType::RVecArray, desc, srcfile, line);
     gmx_fio_unlock(fio);
     return ret;
@@ -0,0 +1,237 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for selective reading of energy files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/enxio.h"
+
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/timecontrol.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of energy terms in the test file
+constexpr int c_numTerms = 4;
+//! The number of frames in the test file
+constexpr int c_numFrames = 4;
+//! The number of values in the data block of each frame
+constexpr int c_numBlockValues = 5;
+
+//! Returns the energy of term \p term in frame \p frame
+real termValue(int frame, int term)
+{
+    return 10 * frame + term;
+}
+
+class EnxReadSelectionTest : public ::testing::Test
+{
+public:
+    EnxReadSelectionTest()
+    {
+        ener_file_t ef = open_enx(fileName_, "w");
+
+        std::vector<gmx_enxnm_t> names(c_numTerms);
+        std::vector<std::string> nameStrings(c_numTerms);
+        for (int term = 0; term < c_numTerms; term++)
+        {
+            nameStrings[term]  = "Term" + std::to_string(term);
+            names[term].name   = const_cast<char*>(nameStrings[term].c_str());
+            names[term].unit   = const_cast<char*>("kJ/mol");
+        }
+        int          nre      = c_numTerms;
+        gmx_enxnm_t* namesPtr = names.data();
+        do_enxnms(ef, &nre, &namesPtr);
+
+        t_enxframe fr;
+        init_enxframe(&fr);
+        fr.nre     = c_numTerms;
+        fr.e_alloc = c_numTerms;
+        snew(fr.ener, c_numTerms);
+        add_blocks_enxframe(&fr, 1);
+        add_subblocks_enxblock(&fr.block[0], 1);
+        std::vector<float> blockValues(c_numBlockValues);
+        fr.block[0].id          = enxDH;
+        fr.block[0].sub[0].type = XdrDataType::Float;
+        fr.block[0].sub[0].nr   = c_numBlockValues;
+        fr.block[0].sub[0].fval = blockValues.data();
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            fr.t      = frame;
+            fr.step   = 10 * frame;
+            fr.nsteps = 10;
+            fr.dt     = 0.1;
+            fr.nsum   = 2;
+            for (int term = 0; term < c_numTerms; term++)
+            {
+                fr.ener[term].e    = termValue(frame, term);
+                fr.ener[term].eav  = 2 * termValue(frame, term);
+                fr.ener[term].esum = 3 * termValue(frame, term);
+            }
+            for (int i = 0; i < c_numBlockValues; i++)
+            {
+                blockValues[i] = 100 * frame + i;
+            }
+            do_enx(ef, &fr);
+        }
+        fr.block[0].sub[0].fval = nullptr;
+        free_enxframe(&fr);
+        done_ener_file(ef);
+    }
+
+    //! Opens the test file for reading
+    ener_file_t openForReading()
+    {
+        ener_file_t  ef    = open_enx(fileName_, "r");
+        int          nre   = 0;
+        gmx_enxnm_t* names = nullptr;
+        do_enxnms(ef, &nre, &names);
+        EXPECT_EQ(nre, c_numTerms);
+        free_enxnms(nre, names);
+        return ef;
+    }
+
+    //! Checks that term \p term in \p fr has the values of frame \p frame
+    static void checkTerm(const t_enxframe& fr, int frame, int term)
+    {
+        EXPECT_EQ(fr.ener[term].e, termValue(frame, term));
+        EXPECT_EQ(fr.ener[term].eav, 2 * termValue(frame, term));
+        EXPECT_EQ(fr.ener[term].esum, 3 * termValue(frame, term));
+    }
+
+    //! Checks that \p fr has the data block of frame \p frame
+    static void checkBlock(const t_enxframe& fr, int frame)
+    {
+        ASSERT_EQ(fr.nblock, 1);
+        ASSERT_EQ(fr.block[0].sub[0].nr, c_numBlockValues);
+        for (int i = 0; i < c_numBlockValues; i++)
+        {
+            EXPECT_EQ(fr.block[0].sub[0].fval[i], 100 * frame + i);
+        }
+    }
+
+    TestFileManager       fileManager_;
+    std::filesystem::path fileName_ = fileManager_.getTemporaryFilePath("energy.edr");
+};
+
+TEST_F(EnxReadSelectionTest, ReadsSelectedTermsWithoutBlocks)
+{
+    ener_file_t ef                    = openForReading();
+    gmx_bool    bReadTerm[c_numTerms] = { FALSE, TRUE, FALSE, TRUE };
+    set_enx_read_selection(ef, c_numTerms, bReadTerm, FALSE, FALSE);
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        ASSERT_TRUE(do_enx(ef, &fr));
+        EXPECT_EQ(fr.step, 10 * frame);
+        EXPECT_EQ(fr.nblock, 0);
+        checkTerm(fr, frame, 1);
+        checkTerm(fr, frame, 3);
+    }
+    EXPECT_FALSE(do_enx(ef, &fr));
+    free_enxframe(&fr);
+    done_ener_file(ef);
+}
+
+TEST_F(EnxReadSelectionTest, ReadsAllTermsAndBlocks)
+{
+    ener_file_t ef = openForReading();
+    set_enx_read_selection(ef, c_numTerms, nullptr, TRUE, FALSE);
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        ASSERT_TRUE(do_enx(ef, &fr));
+        for (int term = 0; term < c_numTerms; term++)
+        {
+            checkTerm(fr, frame, term);
+        }
+        checkBlock(fr, frame);
+    }
+    EXPECT_FALSE(do_enx(ef, &fr));
+    free_enxframe(&fr);
+    done_ener_file(ef);
+}
+
+TEST_F(EnxReadSelectionTest, SkipsFramesOutsideTimeWindow)
+{
+    setTimeValue(TimeControl::Begin, 1.5);
+    ener_file_t ef = openForReading();
+    set_enx_read_selection(ef, c_numTerms, nullptr, TRUE, TRUE);
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        ASSERT_TRUE(do_enx(ef, &fr));
+        EXPECT_EQ(fr.step, 10 * frame);
+        if (frame >= 2)
+        {
+            checkTerm(fr, frame, 0);
+            checkBlock(fr, frame);
+        }
+        else
+        {
+            EXPECT_EQ(fr.nblock, 0);
+        }
+    }
+    EXPECT_FALSE(do_enx(ef, &fr));
+    free_enxframe(&fr);
+    done_ener_file(ef);
+    unsetTimeValue(TimeControl::Begin);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,171 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the trajectory frame prefetcher.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/trajectoryprefetcher.h"
+
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of frames in the test trajectory
+constexpr int c_numFrames = 6;
+//! The number of atoms in the test trajectory
+constexpr int c_numAtoms = 20;
+
+class TrajectoryPrefetcherTest : public ::testing::Test
+{
+public:
+    TrajectoryPrefetcherTest()
+    {
+        t_fileio* fio = open_xtc(fileName_, "w");
+        matrix    box;
+        clear_mat(box);
+        box[XX][XX] = box[YY][YY] = box[ZZ][ZZ] = 3;
+        std::vector<RVec> x(c_numAtoms);
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            for (int a = 0; a < c_numAtoms; a++)
+            {
+                x[a] = { 0.1_real * a, 0.01_real * frame, 1.0_real };
+            }
+            write_xtc(fio,
+                      c_numAtoms,
+                      10 * frame,
+                      0.5_real * frame,
+                      box,
+                      as_rvec_array(x.data()),
+                      1000);
+        }
+        close_xtc(fio);
+
+        clear_trxframe(&frame_, TRUE);
+    }
+
+    ~TrajectoryPrefetcherTest() override { sfree(frame_.x); }
+
+    //! Returns a frame reader for \p fio
+    static TrajectoryPrefetcher::FrameReader xtcReader(t_fileio* fio)
+    {
+        return [fio](t_trxframe* frame) {
+            frame->natoms = c_numAtoms;
+            if (frame->x == nullptr)
+            {
+                snew(frame->x, c_numAtoms);
+            }
+            gmx_bool bOK;
+            frame->bX = frame->bStep = (read_next_xtc(fio,
+                                                      c_numAtoms,
+                                                      &frame->step,
+                                                      &frame->time,
+                                                      frame->box,
+                                                      frame->x,
+                                                      &frame->prec,
+                                                      &bOK)
+                                        != 0);
+            return frame->bX != 0;
+        };
+    }
+
+    //! Checks that frame_ holds frame \p frame
+    void checkFrame(int frame)
+    {
+        EXPECT_EQ(frame_.step, 10 * frame);
+        ASSERT_NE(frame_.x, nullptr);
+        EXPECT_REAL_EQ_TOL(
+                frame_.x[c_numAtoms - 1][YY], 0.01_real * frame, absoluteTolerance(1e-3));
+    }
+
+    TestFileManager       fileManager_;
+    std::filesystem::path fileName_ = fileManager_.getTemporaryFilePath("frames.xtc");
+    t_trxframe            frame_;
+};
+
+TEST_F(TrajectoryPrefetcherTest, ReadsAllFrames)
+{
+    t_fileio* fio = open_xtc(fileName_, "r");
+    {
+        TrajectoryPrefetcher prefetcher(fio, 2, xtcReader(fio));
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            ASSERT_TRUE(prefetcher.nextFrame(&frame_));
+            checkFrame(frame);
+        }
+        EXPECT_FALSE(prefetcher.nextFrame(&frame_));
+        EXPECT_FALSE(prefetcher.nextFrame(&frame_));
+    }
+    close_xtc(fio);
+}
+
+TEST_F(TrajectoryPrefetcherTest, StoppingPositionsFileAfterReturnedFrame)
+{
+    t_fileio* fio = open_xtc(fileName_, "r");
+    {
+        TrajectoryPrefetcher prefetcher(fio, 3, xtcReader(fio));
+        for (int frame = 0; frame < 2; frame++)
+        {
+            ASSERT_TRUE(prefetcher.nextFrame(&frame_));
+            checkFrame(frame);
+        }
+    }
+    ASSERT_TRUE(xtcReader(fio)(&frame_));
+    checkFrame(2);
+    close_xtc(fio);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for reading and writing TRR files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/trrio.h"
+
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the test trajectory
+constexpr int c_numAtoms = 50;
+
+//! Returns the value of component \p d of vector type \p type of atom \p a in frame \p frame
+real frameValue(int frame, int type, int a, int d)
+{
+    return 0.001_real * (a + 1) * (d + 1) + 10 * type - 0.5_real * frame;
+}
+
+//! Writes frames \p frameBegin to \p frameEnd to \p fio
+void writeFrames(t_fileio* fio, int frameBegin, int frameEnd)
+{
+    matrix box;
+    clear_mat(box);
+    box[XX][XX] = box[YY][YY] = box[ZZ][ZZ] = 4;
+    std::vector<RVec> x(c_numAtoms), v(c_numAtoms), f(c_numAtoms);
+    for (int frame = frameBegin; frame < frameEnd; frame++)
+    {
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                x[a][d] = frameValue(frame, 0, a, d);
+                v[a][d] = frameValue(frame, 1, a, d);
+                f[a][d] = frameValue(frame, 2, a, d);
+            }
+        }
+        gmx_trr_write_frame(fio,
+                            10 * frame,
+                            0.5_real * frame,
+                            0,
+                            box,
+                            c_numAtoms,
+                            as_rvec_array(x.data()),
+                            as_rvec_array(v.data()),
+                            as_rvec_array(f.data()));
+    }
+}
+
+//! Reads the next frame from \p fio into the given buffers, returns whether that succeeded
+bool readFrame(t_fileio*          fio,
+               std::vector<RVec>* x,
+               std::vector<RVec>* v,
+               std::vector<RVec>* f,
+               int64_t*           step,
+               matrix             box,
+               int*               natoms)
+{
+    real t, lambda;
+    return gmx_trr_read_frame(fio,
+                              step,
+                              &t,
+                              &lambda,
+                              box,
+                              natoms,
+                              as_rvec_array(x->data()),
+                              as_rvec_array(v->data()),
+                              as_rvec_array(f->data()));
+}
+
+//! Reads the next frame from \p fio and checks that it is frame \p frame
+void checkNextFrame(t_fileio* fio, int frame)
+{
+    int64_t           step;
+    matrix            box;
+    int               natoms;
+    std::vector<RVec> x(c_numAtoms), v(c_numAtoms), f(c_numAtoms);
+    ASSERT_TRUE(readFrame(fio, &x, &v, &f, &step, box, &natoms));
+    EXPECT_EQ(step, 10 * frame);
+    EXPECT_EQ(natoms, c_numAtoms);
+    EXPECT_EQ(box[YY][YY], 4);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(x[a][d], frameValue(frame, 0, a, d));
+            EXPECT_EQ(v[a][d], frameValue(frame, 1, a, d));
+            EXPECT_EQ(f[a][d], frameValue(frame, 2, a, d));
+        }
+    }
+}
+
+/*! \brief Test fixture that reads TRR files with or without memory mapping
+ *
+ * The parameter tells whether memory mapping is enabled.
+ */
+class TrrIOTest : public ::testing::TestWithParam<bool>
+{
+public:
+    TrrIOTest()
+    {
+        if (GetParam())
+        {
+            gmxSetenv("GMX_TRAJECTORY_MMAP", "1", 1);
+        }
+    }
+    ~TrrIOTest() override { gmxUnsetenv("GMX_TRAJECTORY_MMAP"); }
+};
+
+TEST_P(TrrIOTest, ReadsBackWrittenFrames)
+{
+    TestFileManager             fileManager;
+    const std::filesystem::path fileName = fileManager.getTemporaryFilePath("frames.trr");
+
+    t_fileio* fio = gmx_trr_open(fileName, "w");
+    writeFrames(fio, 0, 3);
+    gmx_trr_close(fio);
+
+    fio = gmx_trr_open(fileName, "r");
+    for (int frame = 0; frame < 3; frame++)
+    {
+        checkNextFrame(fio, frame);
+    }
+    gmx_trr_close(fio);
+}
+
+TEST_P(TrrIOTest, ReadsFramesAppendedAfterOpening)
+{
+    TestFileManager             fileManager;
+    const std::filesystem::path fileName = fileManager.getTemporaryFilePath("frames.trr");
+
+    t_fileio* fio = gmx_trr_open(fileName, "w");
+    writeFrames(fio, 0, 2);
+    gmx_trr_close(fio);
+
+    // Frames appended after opening lie beyond a memory map of the file
+    t_fileio* readFio = gmx_trr_open(fileName, "r");
+    checkNextFrame(readFio, 0);
+    fio = gmx_trr_open(fileName, "a");
+    writeFrames(fio, 2, 4);
+    gmx_trr_close(fio);
+    for (int frame = 1; frame < 4; frame++)
+    {
+        checkNextFrame(readFio, frame);
+    }
+    gmx_trr_close(readFio);
+}
+
+INSTANTIATE_TEST_SUITE_P(WithAndWithoutMemoryMapping, TrrIOTest, ::testing::Bool());
+
+TEST(TrrIOMemoryMappingTest, FailsToReadFramesTruncatedAfterOpening)
+{
+    gmxSetenv("GMX_TRAJECTORY_MMAP", "1", 1);
+
+    TestFileManager             fileManager;
+    const std::filesystem::path fileName = fileManager.getTemporaryFilePath("frames.trr");
+
+    t_fileio* fio = gmx_trr_open(fileName, "w");
+    writeFrames(fio, 0, 2);
+    gmx_trr_close(fio);
+
+    // Truncating the file within the data of the first frame, after it has been
+    // mapped, must make reading that frame fail instead of reading from the map
+    fio = gmx_trr_open(fileName, "r");
+    std::filesystem::resize_file(fileName, std::filesystem::file_size(fileName) / 4);
+    int64_t           step;
+    matrix            box;
+    int               natoms;
+    std::vector<RVec> x(c_numAtoms), v(c_numAtoms), f(c_numAtoms);
+    EXPECT_FALSE(readFrame(fio, &x, &v, &f, &step, box, &natoms));
+    gmx_trr_close(fio);
+    gmxUnsetenv("GMX_TRAJECTORY_MMAP");
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
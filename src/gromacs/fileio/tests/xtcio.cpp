@@ -0,0 +1,200 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the XTC frame index.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcio.h"
+
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/timecontrol.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of frames in the test trajectory
+constexpr int c_numFrames = 6;
+//! The number of atoms in the test trajectory, large enough to use compression
+constexpr int c_numAtoms = 20;
+
+class XtcFrameIndexTest : public ::testing::Test
+{
+public:
+    XtcFrameIndexTest()
+    {
+        t_fileio* fio = open_xtc(xtcFileName_, "w");
+        matrix    box;
+        clear_mat(box);
+        box[XX][XX] = box[YY][YY] = box[ZZ][ZZ] = 3;
+        std::vector<RVec> x(c_numAtoms);
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            for (int a = 0; a < c_numAtoms; a++)
+            {
+                x[a] = { 0.1_real * a, 0.01_real * frame, 1.0_real };
+            }
+            write_xtc(fio,
+                      c_numAtoms,
+                      10 * frame,
+                      frameTime(frame),
+                      box,
+                      as_rvec_array(x.data()),
+                      1000);
+        }
+        close_xtc(fio);
+    }
+
+    //! Returns the time of frame \p frame
+    static real frameTime(int frame) { return 0.5_real * frame; }
+
+    TestFileManager       fileManager_;
+    std::filesystem::path xtcFileName_   = fileManager_.getTemporaryFilePath("frames.xtc");
+    std::filesystem::path indexFileName_ = fileManager_.getTemporaryFilePath("frames.xtc.idx");
+};
+
+TEST_F(XtcFrameIndexTest, IndexFileNameAppendsExtension)
+{
+    EXPECT_EQ(xtc_frame_index_filename(xtcFileName_), indexFileName_);
+}
+
+TEST_F(XtcFrameIndexTest, NoIndexGivesEmptyList)
+{
+    t_fileio* fio = open_xtc(xtcFileName_, "r");
+    EXPECT_TRUE(read_xtc_frame_index(fio).empty());
+    close_xtc(fio);
+}
+
+TEST_F(XtcFrameIndexTest, GeneratedIndexListsAllFrames)
+{
+    generate_xtc_frame_index(xtcFileName_);
+
+    t_fileio*                             fio   = open_xtc(xtcFileName_, "r");
+    const std::vector<XtcFrameIndexEntry> index = read_xtc_frame_index(fio);
+    EXPECT_EQ(gmx_fio_ftell(fio), 0);
+    close_xtc(fio);
+
+    ASSERT_EQ(index.size(), static_cast<size_t>(c_numFrames));
+    EXPECT_EQ(index[0].offset, 0);
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        if (frame > 0)
+        {
+            EXPECT_GT(index[frame].offset, index[frame - 1].offset);
+        }
+        EXPECT_EQ(index[frame].step, 10 * frame);
+        EXPECT_EQ(index[frame].time, frameTime(frame));
+    }
+}
+
+TEST_F(XtcFrameIndexTest, AppendedEntriesReplaceTruncatedFrames)
+{
+    generate_xtc_frame_index(xtcFileName_);
+
+    std::vector<XtcFrameIndexEntry> index;
+    {
+        t_fileio* fio = open_xtc(xtcFileName_, "r");
+        index         = read_xtc_frame_index(fio);
+        close_xtc(fio);
+    }
+    ASSERT_EQ(index.size(), static_cast<size_t>(c_numFrames));
+
+    // Mimic a restart that wrote the last two frames again after truncation
+    FILE* fp = open_xtc_frame_index(xtcFileName_, "a");
+    write_xtc_frame_index_entry(fp, index[c_numFrames - 2]);
+    write_xtc_frame_index_entry(fp, index[c_numFrames - 1]);
+    gmx_ffclose(fp);
+
+    t_fileio* fio = open_xtc(xtcFileName_, "r");
+    EXPECT_EQ(read_xtc_frame_index(fio).size(), static_cast<size_t>(c_numFrames));
+    close_xtc(fio);
+}
+
+TEST_F(XtcFrameIndexTest, MismatchingIndexIsIgnored)
+{
+    FILE* fp = open_xtc_frame_index(xtcFileName_, "w");
+    write_xtc_frame_index_entry(fp, { 0, 1, 0 });
+    gmx_ffclose(fp);
+
+    t_fileio* fio = open_xtc(xtcFileName_, "r");
+    EXPECT_TRUE(read_xtc_frame_index(fio).empty());
+    close_xtc(fio);
+}
+
+TEST_F(XtcFrameIndexTest, ReadingWithBeginTimeUsesIndex)
+{
+    generate_xtc_frame_index(xtcFileName_);
+
+    gmx_output_env_t* oenv = nullptr;
+    output_env_init_default(&oenv);
+    setTimeValue(TimeControl::Begin, frameTime(3));
+
+    t_trxstatus* status = nullptr;
+    t_trxframe   frame;
+    ASSERT_TRUE(read_first_frame(oenv, &status, xtcFileName_, &frame, TRX_NEED_X));
+    std::vector<int64_t> steps = { frame.step };
+    while (read_next_frame(oenv, status, &frame))
+    {
+        steps.push_back(frame.step);
+    }
+    close_trx(status);
+    done_frame(&frame);
+
+    unsetTimeValue(TimeControl::Begin);
+    output_env_done(oenv);
+
+    EXPECT_EQ(steps, std::vector<int64_t>({ 30, 40, 50 }));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
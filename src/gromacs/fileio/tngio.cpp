@@ -798,16 +798,16 @@ void gmx_tng_prepare_low_prec_writing(gmx_tng_trajectory_t gmx_tng, const gmx_mt
 #endif
 }
 
-void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
-                    const gmx_bool       bUseLossyCompression,
-                    int64_t              step,
-                    real                 elapsedPicoSeconds,
-                    real                 lambda,
-                    const rvec*          box,
-                    int                  nAtoms,
-                    const rvec*          x,
-                    const rvec*          v,
-                    const rvec*          f)
+bool gmx_tng_write_frame(gmx_tng_trajectory_t gmx_tng,
+                         const gmx_bool       bUseLossyCompression,
+                         int64_t              step,
+                         real                 elapsedPicoSeconds,
+                         real                 lambda,
+                         const rvec*          box,
+                         int                  nAtoms,
+                         const rvec*          x,
+                         const rvec*          v,
+                         const rvec*          f)
 {
 #if GMX_USE_TNG
     typedef tng_function_status (*write_data_func_pointer)(tng_trajectory_t,
@@ -834,7 +834,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
         /* This function might get called when the type of the
            compressed trajectory is actually XTC. So we exit and move
            on. */
-        return;
+        return true;
     }
     tng_trajectory_t tng = gmx_tng->tng;
 
@@ -905,7 +905,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        compression)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -922,7 +922,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        compression)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -941,7 +941,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -960,7 +960,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -979,7 +979,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -989,6 +989,8 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
     gmx_tng->lastStep            = step;
     gmx_tng->lastTimeDataIsValid = true;
     gmx_tng->lastTime            = elapsedSeconds;
+
+    return true;
 #else
     GMX_UNUSED_VALUE(gmx_tng);
     GMX_UNUSED_VALUE(bUseLossyCompression);
@@ -1000,9 +1002,37 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
     GMX_UNUSED_VALUE(x);
     GMX_UNUSED_VALUE(v);
     GMX_UNUSED_VALUE(f);
+
+    return true;
 #endif
 }
 
+void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
+                    const gmx_bool       bUseLossyCompression,
+                    int64_t              step,
+                    real                 elapsedPicoSeconds,
+                    real                 lambda,
+                    const rvec*          box,
+                    int                  nAtoms,
+                    const rvec*          x,
+                    const rvec*          v,
+                    const rvec*          f)
+{
+    if (!gmx_tng_write_frame(gmx_tng,
+                             bUseLossyCompression,
+                             step,
+                             elapsedPicoSeconds,
+                             lambda,
+                             box,
+                             nAtoms,
+                             x,
+                             v,
+                             f))
+    {
+        gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+    }
+}
+
 void fflush_tng(gmx_tng_trajectory_t gmx_tng)
 {
 #if GMX_USE_TNG
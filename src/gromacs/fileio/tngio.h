@@ -126,6 +126,23 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t tng,
                     const rvec*          v,
                     const rvec*          f);
 
+/*! \brief Write a frame to a TNG file, returns false when writing failed
+ *
+ * Parameters as for gmx_fwrite_tng(), which issues a fatal error when
+ * writing fails. This can be used on threads that should not terminate
+ * the program, the caller should then report the error.
+ */
+bool gmx_tng_write_frame(gmx_tng_trajectory_t tng,
+                         gmx_bool             bUseLossyCompression,
+                         int64_t              step,
+                         real                 elapsedPicoSeconds,
+                         real                 lambda,
+                         const rvec*          box,
+                         int                  nAtoms,
+                         const rvec*          x,
+                         const rvec*          v,
+                         const rvec*          f);
+
 /*! \brief Write the current frame set to disk. Perform compression
  * etc.
  *
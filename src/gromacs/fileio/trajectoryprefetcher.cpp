@@ -0,0 +1,212 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the trajectory frame prefetcher.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "trajectoryprefetcher.h"
+
+#include <cstring>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Copies \p natoms vectors from \p src to \p dest, allocates \p dest when \p src is allocated
+void copyFrameVectors(const rvec* src, int natoms, bool haveVectors, rvec** dest)
+{
+    if (src == nullptr)
+    {
+        return;
+    }
+    if (*dest == nullptr)
+    {
+        snew(*dest, natoms);
+    }
+    if (haveVectors)
+    {
+        std::memcpy(*dest, src, natoms * sizeof(rvec));
+    }
+}
+
+} // namespace
+
+TrajectoryPrefetcher::TrajectoryPrefetcher(t_fileio* fio, int numFrames, FrameReader readFrame) :
+    fio_(fio),
+    readFrame_(std::move(readFrame)),
+    slots_(numFrames),
+    consumedEndOffset_(gmx_fio_ftell(fio))
+{
+    GMX_RELEASE_ASSERT(numFrames > 0, "Need to prefetch at least one frame");
+
+    for (Slot& slot : slots_)
+    {
+        clear_trxframe(&slot.frame, TRUE);
+    }
+    thread_ = std::thread([this]() { readLoop(); });
+}
+
+TrajectoryPrefetcher::~TrajectoryPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    stateChanged_.notify_all();
+    thread_.join();
+
+    gmx_fio_seek(fio_, consumedEndOffset_);
+
+    for (Slot& slot : slots_)
+    {
+        sfree(slot.frame.x);
+        sfree(slot.frame.v);
+        sfree(slot.frame.f);
+    }
+}
+
+void TrajectoryPrefetcher::readLoop()
+{
+    const int numSlots = slots_.size();
+    try
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stateChanged_.wait(
+                    lock, [this, numSlots]() { return stopRequested_ || numBuffered_ < numSlots; });
+            if (stopRequested_)
+            {
+                return;
+            }
+            // The slot after the buffered ones is not accessed by the consumer
+            Slot& slot = slots_[(head_ + numBuffered_) % numSlots];
+            lock.unlock();
+
+            clear_trxframe(&slot.frame, FALSE);
+            const bool haveFrame = readFrame_(&slot.frame);
+            slot.haveFrame       = haveFrame;
+            slot.endOffset       = gmx_fio_ftell(fio_);
+
+            lock.lock();
+            numBuffered_++;
+            // Stop after a failed read, the frame still tells the consumer why it failed
+            readingDone_ = !haveFrame;
+            lock.unlock();
+            stateChanged_.notify_all();
+
+            if (!haveFrame)
+            {
+                return;
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            readException_ = std::current_exception();
+            readingDone_   = true;
+        }
+        stateChanged_.notify_all();
+    }
+}
+
+bool TrajectoryPrefetcher::nextFrame(t_trxframe* fr)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    stateChanged_.wait(lock, [this]() { return numBuffered_ > 0 || readingDone_; });
+    if (numBuffered_ == 0)
+    {
+        if (readException_)
+        {
+            std::rethrow_exception(readException_);
+        }
+        return false;
+    }
+    // The oldest buffered slot is not accessed by the reading thread
+    const Slot& slot = slots_[head_];
+    lock.unlock();
+
+    const t_trxframe& frame = slot.frame;
+    fr->not_ok              = frame.not_ok;
+    fr->bDouble             = frame.bDouble;
+    fr->natoms              = frame.natoms;
+    fr->bStep               = frame.bStep;
+    fr->step                = frame.step;
+    fr->bTime               = frame.bTime;
+    fr->time                = frame.time;
+    fr->bLambda             = frame.bLambda;
+    fr->bFepState           = frame.bFepState;
+    fr->lambda              = frame.lambda;
+    fr->fep_state           = frame.fep_state;
+    fr->bPrec               = frame.bPrec;
+    fr->prec                = frame.prec;
+    fr->bX                  = frame.bX;
+    fr->bV                  = frame.bV;
+    fr->bF                  = frame.bF;
+    fr->bBox                = frame.bBox;
+    copy_mat(frame.box, fr->box);
+    copyFrameVectors(frame.x, frame.natoms, frame.bX, &fr->x);
+    copyFrameVectors(frame.v, frame.natoms, frame.bV, &fr->v);
+    copyFrameVectors(frame.f, frame.natoms, frame.bF, &fr->f);
+
+    const bool haveFrame = slot.haveFrame;
+    if (haveFrame)
+    {
+        consumedEndOffset_ = slot.endOffset;
+    }
+
+    lock.lock();
+    head_ = (head_ + 1) % static_cast<int>(slots_.size());
+    numBuffered_--;
+    lock.unlock();
+    stateChanged_.notify_all();
+
+    return haveFrame;
+}
+
+} // namespace gmx
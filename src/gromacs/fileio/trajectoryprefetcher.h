@@ -0,0 +1,141 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares a reader that prefetches trajectory frames on a background thread.
+ *
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_TRAJECTORYPREFETCHER_H
+#define GMX_FILEIO_TRAJECTORYPREFETCHER_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/futil.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+
+/*! \internal
+ * \brief Reads and decodes trajectory frames ahead of their use.
+ *
+ * A background thread reads frames from a file into a ring buffer, so
+ * decompression of the next frames overlaps with the processing of the
+ * current frame by the caller. While the prefetcher exists, the background
+ * thread owns the file and nobody else may access it. Destroying the
+ * prefetcher stops the thread and positions the file directly after the
+ * last frame returned by nextFrame(), so reading can continue as if all
+ * frames had been read synchronously.
+ */
+class TrajectoryPrefetcher
+{
+public:
+    /*! \brief Function that reads the next frame from the file
+     *
+     * Returns whether a frame was read. The frame passed is owned by the
+     * prefetcher and reused, the function should allocate the coordinate
+     * buffers it needs when they are nullptr.
+     */
+    using FrameReader = std::function<bool(t_trxframe*)>;
+
+    /*! \brief Constructor, starts reading \p numFrames frames ahead
+     *
+     * \param[in] fio        The file to read from, at the position of the next frame
+     * \param[in] numFrames  The number of frames to buffer, should be at least 1
+     * \param[in] readFrame  Reads the next frame from \p fio
+     */
+    TrajectoryPrefetcher(t_fileio* fio, int numFrames, FrameReader readFrame);
+
+    //! Stops reading and positions the file after the last returned frame
+    ~TrajectoryPrefetcher();
+
+    /*! \brief Copies the next frame into \p fr and returns whether there was a frame
+     *
+     * The coordinate arrays in \p fr are reused, or allocated when nullptr.
+     * Rethrows exceptions thrown by the frame reader.
+     */
+    bool nextFrame(t_trxframe* fr);
+
+private:
+    //! A buffered frame with the result of reading it
+    struct Slot
+    {
+        //! The frame, with buffers owned by the prefetcher
+        t_trxframe frame;
+        //! Whether a frame was read
+        bool haveFrame = false;
+        //! The file position after reading this frame
+        gmx_off_t endOffset = 0;
+    };
+
+    //! The loop run by the reading thread
+    void readLoop();
+
+    //! The file to read from
+    t_fileio* fio_;
+    //! Reads the next frame
+    FrameReader readFrame_;
+    //! Ring buffer of frames
+    std::vector<Slot> slots_;
+    //! Index of the oldest buffered frame
+    int head_ = 0;
+    //! The number of buffered frames
+    int numBuffered_ = 0;
+    //! Whether the reading thread should stop
+    bool stopRequested_ = false;
+    //! Whether the reading thread stopped after failing to read a frame
+    bool readingDone_ = false;
+    //! An exception thrown by the frame reader, rethrown by nextFrame()
+    std::exception_ptr readException_;
+    //! The file position after the last frame returned by nextFrame()
+    gmx_off_t consumedEndOffset_;
+    //! Protects the ring buffer state
+    std::mutex mutex_;
+    //! Signals changes of the ring buffer state
+    std::condition_variable stateChanged_;
+    //! The reading thread
+    std::thread thread_;
+};
+
+} // namespace gmx
+
+#endif
@@ -41,11 +41,15 @@
 #include <cinttypes>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/confio.h"
@@ -80,6 +84,8 @@
 #include "gromacs/utility/real.h"
 #include "gromacs/utility/smalloc.h"
 
+#include "trajectoryprefetcher.h"
+
 struct gmx_output_env_t;
 
 #if GMX_USE_PLUGINS
@@ -103,6 +109,8 @@ struct t_trxstatus
     gmx_tng_trajectory_t tng;
     int                  natoms;
     char*                persistent_line; /* Persistent line for reading g96 trajectories */
+    std::vector<XtcFrameIndexEntry>* xtcFrameIndex; /* Frame index for XTC files, can be nullptr */
+    gmx::TrajectoryPrefetcher* prefetcher; /* Reads frames ahead, can be nullptr */
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
@@ -186,6 +194,15 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->xtcFrameIndex   = nullptr;
+    status->prefetcher      = nullptr;
+}
+
+/* Stops reading ahead, the file is then positioned after the last returned frame */
+static void stop_prefetching(t_trxstatus* status)
+{
+    delete status->prefetcher;
+    status->prefetcher = nullptr;
 }
 
 
@@ -254,6 +271,9 @@ real ndec2prec(int ndec)
 
 t_fileio* trx_get_fileio(t_trxstatus* status)
 {
+    /* The caller might access the file, which the prefetching thread owns */
+    stop_prefetching(status);
+
     return status->fio;
 }
 
@@ -654,12 +674,14 @@ void close_trx(t_trxstatus* status)
     {
         return;
     }
+    stop_prefetching(status);
     gmx_tng_close(&status->tng);
     if (status->fio)
     {
         gmx_fio_close(status->fio);
     }
     sfree(status->persistent_line);
+    delete status->xtcFrameIndex;
 #if GMX_USE_PLUGINS
     delete status->vmdplugin;
 #endif
@@ -832,11 +854,114 @@ static int pdb_first_x(t_trxstatus* status, FILE* fp, t_trxframe* fr)
     return fr->natoms;
 }
 
+//! Reads the next XTC frame into \p fr, returns whether a frame was read
+static gmx_bool xtc_next_frame(t_trxstatus* status, t_trxframe* fr)
+{
+    gmx_bool bOK;
+    gmx_bool bRet = (read_next_xtc(status->fio,
+                                   fr->natoms,
+                                   &fr->step,
+                                   &fr->time,
+                                   fr->box,
+                                   fr->x,
+                                   &fr->prec,
+                                   &bOK)
+                     != 0);
+    fr->bPrec = (bRet && fr->prec > 0);
+    fr->bStep = bRet;
+    fr->bTime = bRet;
+    fr->bX    = bRet;
+    fr->bBox  = bRet;
+    if (!bOK)
+    {
+        /* Actually the header could also be not ok,
+           but from bOK from read_next_xtc this can't be distinguished */
+        fr->not_ok = DATA_NOT_OK;
+    }
+
+    return bRet;
+}
+
+/* Returns the number of frames to read ahead on a separate thread, 0 when not prefetching */
+static int trx_num_prefetch_frames()
+{
+    static const int sc_numPrefetchFrames = []() {
+        const char* env = std::getenv("GMX_TRAJECTORY_PREFETCH");
+        return (env != nullptr) ? std::max(std::atoi(env), 0) : 0;
+    }();
+
+    return sc_numPrefetchFrames;
+}
+
+/* Starts reading XTC and TRR frames ahead on a separate thread when requested
+ * and when no seeking is needed to get to the next frame to process.
+ */
+static void start_prefetching(t_trxstatus* status, int ftp, const t_trxframe* fr)
+{
+    auto startTime = timeValue(TimeControl::Begin);
+    if (trx_num_prefetch_frames() == 0 || !(ftp == efXTC || ftp == efTRR)
+        || status->xtcFrameIndex != nullptr
+        || (startTime.has_value() && status->tf < startTime.value()))
+    {
+        return;
+    }
+
+    gmx::TrajectoryPrefetcher::FrameReader readFrame;
+    if (ftp == efXTC)
+    {
+        const int natoms = fr->natoms;
+        readFrame        = [status, natoms](t_trxframe* frame) {
+            frame->natoms = natoms;
+            if (frame->x == nullptr)
+            {
+                snew(frame->x, natoms);
+            }
+            return xtc_next_frame(status, frame) != 0;
+        };
+    }
+    else
+    {
+        readFrame = [status](t_trxframe* frame) { return gmx_next_frame(status, frame) != 0; };
+    }
+    status->prefetcher =
+            new gmx::TrajectoryPrefetcher(status->fio, trx_num_prefetch_frames(), std::move(readFrame));
+}
+
+/*! \brief Uses the XTC frame index to skip frames that would be skipped after reading them
+ *
+ * Only seeks when the current file position is the start of an indexed frame,
+ * so frames that are not in the index are never skipped.
+ */
+static void xtc_skip_frames_using_index(t_trxstatus* status)
+{
+    const std::vector<XtcFrameIndexEntry>& index    = *status->xtcFrameIndex;
+    const gmx_off_t                        position = gmx_fio_ftell(status->fio);
+
+    auto frame = std::lower_bound(index.begin(),
+                                  index.end(),
+                                  position,
+                                  [](const XtcFrameIndexEntry& entry, gmx_off_t offset) {
+                                      return entry.offset < offset;
+                                  });
+    if (frame == index.end() || frame->offset != position)
+    {
+        return;
+    }
+    while (frame != index.end() && check_times2(frame->time, status->t0, FALSE) < 0)
+    {
+        ++frame;
+    }
+    if (frame != index.end() && frame->offset != position)
+    {
+        gmx_fio_seek(status->fio, frame->offset);
+    }
+}
+
 bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxframe* fr)
 {
     real     pt;
     int      ct;
-    gmx_bool bOK, bMissingData = FALSE, bSkip = FALSE;
+    gmx_bool bMissingData = FALSE, bSkip = FALSE;
     bool     bRet = false;
     int      ftp;
 
@@ -855,10 +980,17 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
         {
             ftp = gmx_fio_getftp(status->fio);
         }
+        if (status->prefetcher == nullptr)
+        {
+            start_prefetching(status, ftp, fr);
+        }
         auto startTime = timeValue(TimeControl::Begin);
         switch (ftp)
         {
-            case efTRR: bRet = gmx_next_frame(status, fr); break;
+            case efTRR:
+                bRet = (status->prefetcher != nullptr) ? status->prefetcher->nextFrame(fr)
+                                                       : gmx_next_frame(status, fr);
+                break;
             case efCPT:
                 /* Checkpoint files can not contain mulitple frames */
                 break;
@@ -870,7 +1002,16 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                 break;
             }
             case efXTC:
-                if (startTime.has_value() && (status->tf < startTime.value()))
+                if (status->prefetcher != nullptr)
+                {
+                    bRet = status->prefetcher->nextFrame(fr);
+                    break;
+                }
+                if (status->xtcFrameIndex)
+                {
+                    xtc_skip_frames_using_index(status);
+                }
+                else if (startTime.has_value() && (status->tf < startTime.value()))
                 {
                     if (xtc_seek_time(status->fio, startTime.value(), fr->natoms, TRUE))
                     {
@@ -881,20 +1022,7 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                     }
                     initcount(status);
                 }
-                bRet      = (read_next_xtc(
-                                status->fio, fr->natoms, &fr->step, &fr->time, fr->box, fr->x, &fr->prec, &bOK)
-                        != 0);
-                fr->bPrec = (bRet && fr->prec > 0);
-                fr->bStep = bRet;
-                fr->bTime = bRet;
-                fr->bX    = bRet;
-                fr->bBox  = bRet;
-                if (!bOK)
-                {
-                    /* Actually the header could also be not ok,
-                       but from bOK from read_next_xtc this can't be distinguished */
-                    fr->not_ok = DATA_NOT_OK;
-                }
+                bRet = xtc_next_frame(status, fr);
                 break;
             case efTNG: bRet = gmx_read_next_tng_frame(status->tng, fr, nullptr, 0); break;
             case efPDB: bRet = pdb_next_x(status, gmx_fio_getfp(status->fio), fr); break;
@@ -940,6 +1068,8 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
 
     if (!bRet)
     {
+        /* Continue synchronously from the last frame read, e.g. when the file grows */
+        stop_prefetching(status);
         printlast(status, oenv, pt);
         if (fr->not_ok)
         {
@@ -1030,6 +1160,16 @@ bool read_first_frame(const gmx_output_env_t*      oenv,
                 fr->bX    = TRUE;
                 fr->bBox  = TRUE;
                 printcount(*status, oenv, fr->time, FALSE);
+
+                if (!(flags & TRX_DONT_SKIP))
+                {
+                    std::vector<XtcFrameIndexEntry> index = read_xtc_frame_index(fio);
+                    if (!index.empty())
+                    {
+                        (*status)->xtcFrameIndex =
+                                new std::vector<XtcFrameIndexEntry>(std::move(index));
+                    }
+                }
             }
             bFirst = FALSE;
             break;
@@ -1152,6 +1292,7 @@ gmx_bool read_next_x(const gmx_output_env_t* oenv, t_trxstatus* status, real* t,
 
 void rewind_trj(t_trxstatus* status)
 {
+    stop_prefetching(status);
     initcount(status);
 
     gmx_fio_rewind(status->fio);
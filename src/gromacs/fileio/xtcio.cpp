@@ -35,13 +35,18 @@
 
 #include "xtcio.h"
 
+#include <cinttypes>
 #include <cstdio>
 #include <cstring>
 
+#include <string>
+#include <system_error>
+
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/iserializer.h"
@@ -285,3 +290,163 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
 
     return static_cast<int>(*bOK);
 }
+
+std::filesystem::path xtc_frame_index_filename(const std::filesystem::path& xtcFileName)
+{
+    std::filesystem::path indexFileName = xtcFileName;
+    indexFileName += ".idx";
+
+    return indexFileName;
+}
+
+//! The first line of an XTC frame index file
+static const char* const sc_xtcFrameIndexHeader = "# GROMACS XTC frame index: offset step time";
+
+FILE* open_xtc_frame_index(const std::filesystem::path& xtcFileName, const char* mode)
+{
+    const std::filesystem::path indexFileName = xtc_frame_index_filename(xtcFileName);
+
+    std::error_code errorCode;
+    const bool      writeHeader =
+            (mode[0] == 'w' || !std::filesystem::exists(indexFileName, errorCode));
+
+    FILE* fp = gmx_ffopen(indexFileName, mode);
+    if (writeHeader)
+    {
+        fprintf(fp, "%s\n", sc_xtcFrameIndexHeader);
+    }
+
+    return fp;
+}
+
+void write_xtc_frame_index_entry(FILE* fp, const XtcFrameIndexEntry& entry)
+{
+    fprintf(fp,
+            "%" PRId64 " %" PRId64 " %.9g\n",
+            static_cast<int64_t>(entry.offset),
+            entry.step,
+            static_cast<double>(entry.time));
+    fflush(fp);
+}
+
+/*! \brief Returns whether the frame header at the offset of \p entry matches the entry
+ *
+ * Changes the file position.
+ */
+static bool xtc_frame_index_entry_matches(t_fileio* fio, const XtcFrameIndexEntry& entry)
+{
+    if (gmx_fio_seek(fio, entry.offset) != 0)
+    {
+        return false;
+    }
+
+    int      magic  = 0;
+    int      natoms = 0;
+    int64_t  step   = 0;
+    real     time   = 0;
+    gmx_bool bOK    = FALSE;
+    if (!xtc_header(gmx_fio_getxdr(fio), &magic, &natoms, &step, &time, TRUE, &bOK) || !bOK)
+    {
+        return false;
+    }
+
+    /* The XTC header stores the step as a 32-bit integer. The index stores
+     * the time with enough digits to reproduce the float value in the file.
+     */
+    return (magic == XTC_MAGIC || magic == XTC_NEW_MAGIC) && step == static_cast<int>(entry.step)
+           && static_cast<float>(time) == static_cast<float>(entry.time);
+}
+
+std::vector<XtcFrameIndexEntry> read_xtc_frame_index(t_fileio* fio)
+{
+    std::vector<XtcFrameIndexEntry> entries;
+
+    const std::filesystem::path xtcFileName   = gmx_fio_getname(fio);
+    const std::filesystem::path indexFileName = xtc_frame_index_filename(xtcFileName);
+
+    std::error_code errorCode;
+    if (!std::filesystem::exists(indexFileName, errorCode))
+    {
+        return entries;
+    }
+    const auto fileSize = std::filesystem::file_size(xtcFileName, errorCode);
+    if (errorCode)
+    {
+        return entries;
+    }
+
+    FILE* fp = gmx_ffopen(indexFileName, "r");
+    char  line[STRLEN];
+    while (fgets(line, STRLEN, fp) != nullptr)
+    {
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        int64_t offset = 0;
+        int64_t step   = 0;
+        double  time   = 0;
+        if (sscanf(line, "%" SCNd64 " %" SCNd64 " %lf", &offset, &step, &time) != 3)
+        {
+            // A partly written last line, or not an index file
+            break;
+        }
+        if (offset < 0 || static_cast<uintmax_t>(offset) >= fileSize)
+        {
+            continue;
+        }
+        // Frames written after truncating the trajectory replace the old frames
+        while (!entries.empty() && entries.back().offset >= offset)
+        {
+            entries.pop_back();
+        }
+        entries.push_back({ offset, step, static_cast<real>(time) });
+    }
+    gmx_ffclose(fp);
+
+    if (!entries.empty())
+    {
+        const gmx_off_t position = gmx_fio_ftell(fio);
+        const bool      indexMatchesFile = (xtc_frame_index_entry_matches(fio, entries.front())
+                                       && xtc_frame_index_entry_matches(fio, entries.back()));
+        gmx_fio_seek(fio, position);
+
+        if (!indexMatchesFile)
+        {
+            fprintf(stderr,
+                    "\nWARNING: Ignoring XTC frame index '%s', it does not match the XTC file\n",
+                    indexFileName.string().c_str());
+            entries.clear();
+        }
+    }
+
+    return entries;
+}
+
+void generate_xtc_frame_index(const std::filesystem::path& xtcFileName)
+{
+    t_fileio* fio = open_xtc(xtcFileName, "r");
+    FILE*     fp  = open_xtc_frame_index(xtcFileName, "w");
+
+    int                 natoms = 0;
+    XtcFrameIndexEntry  entry  = { 0, 0, 0 };
+    matrix              box;
+    rvec*               x    = nullptr;
+    real                prec = 0;
+    gmx_bool            bOK  = FALSE;
+    if (read_first_xtc(fio, &natoms, &entry.step, &entry.time, box, &x, &prec, &bOK) && bOK)
+    {
+        write_xtc_frame_index_entry(fp, entry);
+
+        entry.offset = gmx_fio_ftell(fio);
+        while (read_next_xtc(fio, natoms, &entry.step, &entry.time, box, x, &prec, &bOK) && bOK)
+        {
+            write_xtc_frame_index_entry(fp, entry);
+            entry.offset = gmx_fio_ftell(fio);
+        }
+    }
+
+    sfree(x);
+    gmx_ffclose(fp);
+    close_xtc(fio);
+}
@@ -36,11 +36,14 @@
 #define GMX_FILEIO_XTCIO_H
 
 #include <cstdint>
+#include <cstdio>
 
 #include <filesystem>
+#include <vector>
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/real.h"
 
 struct t_fileio;
@@ -78,4 +81,39 @@ int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, m
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+/* An XTC file can have a frame index file, which lists the byte offset,
+ * step and time of each frame. Readers use it to skip over frames
+ * without decompressing them.
+ */
+
+//! Entry for one frame in an XTC frame index
+struct XtcFrameIndexEntry
+{
+    //! The byte offset of the frame header in the XTC file
+    gmx_off_t offset;
+    //! The step of the frame
+    int64_t step;
+    //! The time of the frame
+    real time;
+};
+
+std::filesystem::path xtc_frame_index_filename(const std::filesystem::path& xtcFileName);
+/* Returns the name of the frame index file of an XTC file */
+
+FILE* open_xtc_frame_index(const std::filesystem::path& xtcFileName, const char* mode);
+/* Opens the frame index of an XTC file for writing, mode should be "w" or "a" */
+
+void write_xtc_frame_index_entry(FILE* fp, const XtcFrameIndexEntry& entry);
+/* Writes an entry to a frame index opened with open_xtc_frame_index and flushes it */
+
+std::vector<XtcFrameIndexEntry> read_xtc_frame_index(struct t_fileio* fio);
+/* Reads the frame index of the XTC file open as fio, the file position is not changed.
+ * Entries superseded by later entries with a lower or equal offset, which occur
+ * after appending to a truncated trajectory, are removed.
+ * Returns an empty list when there is no index or when it does not match the file.
+ */
+
+void generate_xtc_frame_index(const std::filesystem::path& xtcFileName);
+/* Reads all frames of an XTC file and writes its frame index */
+
 #endif
@@ -2003,10 +2003,21 @@ int gmx_energy(int argc, char* argv[])
         {
             gmx_fatal(FARGS, "Printing averages can only be done when a single set is selected");
         }
+
+        /* Only decode the selected terms, for frames within the time window */
+        gmx_bool* bReadTerm;
+        snew(bReadTerm, nre);
+        for (i = 0; i < nset; i++)
+        {
+            bReadTerm[set[i]] = TRUE;
+        }
+        set_enx_read_selection(fp, nre, bReadTerm, FALSE, TRUE);
+        sfree(bReadTerm);
     }
     else if (bDHDL)
     {
         get_dhdl_parms(ftp2fn(efTPR, NFILE, fnm), ir);
+        set_enx_read_selection(fp, nre, nullptr, TRUE, TRUE);
     }
 
     /* Initiate energies and set them to zero */
@@ -62,8 +62,10 @@
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vecdump.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/topology/atoms.h"
 #include "gromacs/topology/idef.h"
 #include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arrayref.h"
@@ -135,15 +137,14 @@ static int get_nharm(const gmx_mtop_t* mtop)
     return nh;
 }
 
-static void nma_full_hessian(real*                    hess,
-                             int                      ndim,
-                             gmx_bool                 bM,
-                             const t_topology*        top,
-                             gmx::ArrayRef<const int> atom_index,
-                             int                      begin,
-                             int                      end,
-                             real*                    eigenvalues,
-                             real*                    eigenvectors)
+static void nma_full_hessian(real*                     hess,
+                             int                       ndim,
+                             gmx_bool                  bM,
+                             gmx::ArrayRef<const real> masses,
+                             int                       begin,
+                             int                       end,
+                             real*                     eigenvalues,
+                             real*                     eigenvectors)
 {
     real mass_fac;
 
@@ -151,15 +152,13 @@ static void nma_full_hessian(real*                    hess,
 
     if (bM)
     {
-        for (int i = 0; (i < atom_index.ssize()); i++)
+        for (int i = 0; (i < masses.ssize()); i++)
         {
-            size_t ai = atom_index[i];
             for (size_t j = 0; (j < DIM); j++)
             {
-                for (int k = 0; (k < atom_index.ssize()); k++)
+                for (int k = 0; (k < masses.ssize()); k++)
                 {
-                    size_t ak = atom_index[k];
-                    mass_fac  = gmx::invsqrt(top->atoms.atom[ai].m * top->atoms.atom[ak].m);
+                    mass_fac = gmx::invsqrt(masses[i] * masses[k]);
                     for (size_t l = 0; (l < DIM); l++)
                     {
                         hess[(i * DIM + j) * ndim + k * DIM + l] *= mass_fac;
@@ -181,10 +180,9 @@ static void nma_full_hessian(real*                    hess,
     {
         for (int i = 0; i < (end - begin + 1); i++)
         {
-            for (gmx::Index j = 0; j < atom_index.ssize(); j++)
+            for (gmx::Index j = 0; j < masses.ssize(); j++)
             {
-                size_t aj = atom_index[j];
-                mass_fac  = gmx::invsqrt(top->atoms.atom[aj].m);
+                mass_fac = gmx::invsqrt(masses[j]);
                 for (size_t k = 0; (k < DIM); k++)
                 {
                     eigenvectors[i * ndim + j * DIM + k] *= mass_fac;
@@ -195,13 +193,12 @@ static void nma_full_hessian(real*                    hess,
 }
 
 
-static void nma_sparse_hessian(gmx_sparsematrix_t*      sparse_hessian,
-                               gmx_bool                 bM,
-                               const t_topology*        top,
-                               gmx::ArrayRef<const int> atom_index,
-                               int                      neig,
-                               real*                    eigenvalues,
-                               real*                    eigenvectors)
+static void nma_sparse_hessian(gmx_sparsematrix_t*       sparse_hessian,
+                               gmx_bool                  bM,
+                               gmx::ArrayRef<const real> masses,
+                               int                       neig,
+                               real*                     eigenvalues,
+                               real*                     eigenvectors)
 {
     int    i, k;
     int    row, col;
@@ -209,7 +206,7 @@ static void nma_sparse_hessian(gmx_sparsematrix_t*      sparse_hessian,
     int    katom;
     size_t ndim;
 
-    ndim = DIM * atom_index.size();
+    ndim = DIM * masses.size();
 
     /* Cannot check symmetry since we only store half matrix */
     /* divide elements hess[i][j] by sqrt(mas[i])*sqrt(mas[j]) when required */
@@ -219,18 +216,16 @@ static void nma_sparse_hessian(gmx_sparsematrix_t*      sparse_hessian,
 
     if (bM)
     {
-        for (int iatom = 0; (iatom < atom_index.ssize()); iatom++)
+        for (int iatom = 0; (iatom < masses.ssize()); iatom++)
         {
-            size_t ai = atom_index[iatom];
             for (size_t j = 0; (j < DIM); j++)
             {
                 row = DIM * iatom + j;
                 for (k = 0; k < sparse_hessian->ndata[row]; k++)
                 {
-                    col       = sparse_hessian->data[row][k].col;
-                    katom     = col / 3;
-                    size_t ak = atom_index[katom];
-                    mass_fac  = gmx::invsqrt(top->atoms.atom[ai].m * top->atoms.atom[ak].m);
+                    col      = sparse_hessian->data[row][k].col;
+                    katom    = col / 3;
+                    mass_fac = gmx::invsqrt(masses[iatom] * masses[katom]);
                     sparse_hessian->data[row][k].value *= mass_fac;
                 }
             }
@@ -246,10 +241,9 @@ static void nma_sparse_hessian(gmx_sparsematrix_t*      sparse_hessian,
     {
         for (i = 0; i < neig; i++)
         {
-            for (gmx::Index j = 0; j < atom_index.ssize(); j++)
+            for (gmx::Index j = 0; j < masses.ssize(); j++)
             {
-                size_t aj = atom_index[j];
-                mass_fac  = gmx::invsqrt(top->atoms.atom[aj].m);
+                mass_fac = gmx::invsqrt(masses[j]);
                 for (k = 0; (k < DIM); k++)
                 {
                     eigenvectors[i * ndim + j * DIM + k] *= mass_fac;
@@ -343,33 +337,40 @@ static double calcRotationalHeatCapacity(gmx_bool linear)
     }
 }
 
-static void analyzeThermochemistry(FILE*                    fp,
-                                   const t_topology&        top,
-                                   rvec                     top_x[],
-                                   gmx::ArrayRef<const int> atom_index,
-                                   real                     eigfreq[],
-                                   real                     T,
-                                   real                     P,
-                                   int                      sigma_r,
-                                   real                     scale_factor,
-                                   real                     linear_toler)
+static void analyzeThermochemistry(FILE*                     fp,
+                                   int                       natoms,
+                                   rvec                      top_x[],
+                                   gmx::ArrayRef<const int>  atom_index,
+                                   gmx::ArrayRef<const real> masses,
+                                   real                      eigfreq[],
+                                   real                      T,
+                                   real                      P,
+                                   int                       sigma_r,
+                                   real                      scale_factor,
+                                   real                      linear_toler)
 {
-    std::vector<int> index(atom_index.begin(), atom_index.end());
+    /* Only the atoms in the Hessian are needed, so we use compact arrays
+     * of their masses and coordinates, indexed by position in atom_index.
+     */
+    std::vector<int>       index(atom_index.size());
+    std::vector<t_atom>    atoms(atom_index.size());
+    std::vector<gmx::RVec> x_com(atom_index.size());
+    for (gmx::Index i = 0; i < atom_index.ssize(); i++)
+    {
+        index[i]   = i;
+        atoms[i].m = masses[i];
+        copy_rvec(top_x[atom_index[i]], x_com[i]);
+    }
 
+    rvec*  x = as_rvec_array(x_com.data());
     rvec   xcm;
-    double tmass  = calc_xcm(top_x, index.size(), index.data(), top.atoms.atom, xcm, FALSE);
+    double tmass  = calc_xcm(x, index.size(), index.data(), atoms.data(), xcm, FALSE);
     double Strans = calcTranslationalEntropy(tmass, T, P);
-    std::vector<gmx::RVec> x_com;
-    x_com.resize(top.atoms.nr);
-    for (int i = 0; i < top.atoms.nr; i++)
-    {
-        copy_rvec(top_x[i], x_com[i]);
-    }
-    (void)sub_xcm(as_rvec_array(x_com.data()), index.size(), index.data(), top.atoms.atom, xcm, FALSE);
+    (void)sub_xcm(x, index.size(), index.data(), atoms.data(), xcm, FALSE);
 
     rvec   inertia;
     matrix trans;
-    principal_comp(index.size(), index.data(), top.atoms.atom, as_rvec_array(x_com.data()), trans, inertia);
+    principal_comp(index.size(), index.data(), atoms.data(), x, trans, inertia);
     bool linear = (inertia[XX] / inertia[YY] < linear_toler && inertia[XX] / inertia[ZZ] < linear_toler);
     // (kJ/mol ps)^2/(Dalton nm^2 kJ/mol K) =
     // c_kilo kg m^2 ps^2/(s^2 mol g/mol nm^2 K) =
@@ -401,7 +402,7 @@ static void analyzeThermochemistry(FILE*                    fp,
     auto   eFreq = gmx::arrayRefFromArray(eigfreq, nFreq);
     double Svib  = calcQuasiHarmonicEntropy(eFreq, T, linear, scale_factor);
 
-    double Srot = calcRotationalEntropy(T, top.atoms.nr, linear, theta, sigma_r);
+    double Srot = calcRotationalEntropy(T, natoms, linear, theta, sigma_r);
     fprintf(fp, "Translational entropy %g J/mol K\n", Strans);
     fprintf(fp, "Rotational entropy    %g J/mol K\n", Srot);
     fprintf(fp, "Vibrational entropy   %g J/mol K\n", Svib);
@@ -514,7 +515,6 @@ int gmx_nmeig(int argc, char* argv[])
           "Width (sigma) of the gaussian peaks (1/cm) when generating a spectrum" }
     };
     FILE *                     out, *qc, *spec;
-    t_topology                 top;
     gmx_mtop_t                 mtop;
     rvec*                      top_x;
     matrix                     box;
@@ -558,7 +558,14 @@ int gmx_nmeig(int argc, char* argv[])
     }
     std::vector<int> atom_index = get_atom_index(mtop);
 
-    top = gmx_mtop_t_to_t_topology(&mtop, true);
+    /* Only the masses of the atoms in the Hessian are used, so we look these
+     * up directly in mtop instead of expanding the topology */
+    std::vector<real> masses(atom_index.size());
+    int               molb = 0;
+    for (gmx::Index i = 0; i < gmx::ssize(atom_index); i++)
+    {
+        masses[i] = mtopGetAtomMass(mtop, atom_index[i], &molb);
+    }
 
     bM       = TRUE;
     int ndim = DIM * atom_index.size();
@@ -635,7 +642,7 @@ int gmx_nmeig(int argc, char* argv[])
         /* Using full matrix storage */
         eigenvectors = allocateEigenvectors(nrow, begin, end, false);
 
-        nma_full_hessian(full_hessian, nrow, bM, &top, atom_index, begin, end, eigenvalues, eigenvectors);
+        nma_full_hessian(full_hessian, nrow, bM, masses, begin, end, eigenvalues, eigenvectors);
     }
     else
     {
@@ -643,7 +650,7 @@ int gmx_nmeig(int argc, char* argv[])
         /* Sparse memory storage, allocate memory for eigenvectors */
         eigenvectors = allocateEigenvectors(nrow, begin, end, true);
 
-        nma_sparse_hessian(sparse_hessian, bM, &top, atom_index, end, eigenvalues, eigenvectors);
+        nma_sparse_hessian(sparse_hessian, bM, masses, end, eigenvalues, eigenvectors);
     }
 
     /* check the output, first 6 eigenvalues should be reasonably small */
@@ -832,8 +839,17 @@ int gmx_nmeig(int argc, char* argv[])
 
     if (begin == 1)
     {
-        analyzeThermochemistry(
-                stdout, top, top_x, atom_index, eigenvalues, T, P, sigma_r, scale_factor, linear_toler);
+        analyzeThermochemistry(stdout,
+                               mtop.natoms,
+                               top_x,
+                               atom_index,
+                               masses,
+                               eigenvalues,
+                               T,
+                               P,
+                               sigma_r,
+                               scale_factor,
+                               linear_toler);
         please_cite(stdout, "Spoel2018a");
     }
     else
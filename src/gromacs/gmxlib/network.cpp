@@ -96,6 +96,123 @@ std::unique_ptr<t_commrec> init_commrec(MPI_Comm communicator)
     return cr;
 }
 
+/* MPI-3 shared-memory windows are used for summing within a node.
+ * Thread-MPI does not support windows, but there all ranks are
+ * on the same node and do not use the two step summing.
+ */
+#if GMX_LIB_MPI && MPI_VERSION >= 3
+#    define GMX_NODECOMM_SHARED_MEMORY 1
+#else
+#    define GMX_NODECOMM_SHARED_MEMORY 0
+#endif
+
+#if GMX_NODECOMM_SHARED_MEMORY
+/*! \brief The number of doubles per rank in the shared summation buffer
+ *
+ * The buffers summed in global_stat are normally much smaller than this.
+ * Larger buffers are summed with MPI collectives instead.
+ */
+static constexpr std::size_t c_nodeSharedSumBufferSize = 16384;
+
+//! Allocates the shared-memory window for summing within the node
+static void setupNodeSharedSumBuffer(gmx_nodecomm_t* nc)
+{
+    /* Intra-node rank 0 allocates all slots, so they are contiguous */
+    const std::size_t numElements = (nc->rank_intra == 0)
+                                            ? (nc->size_intra + 1) * c_nodeSharedSumBufferSize
+                                            : 0;
+    double*           localBase   = nullptr;
+    int               rc          = MPI_Win_allocate_shared(numElements * sizeof(double),
+                                             sizeof(double),
+                                             MPI_INFO_NULL,
+                                             nc->comm_intra,
+                                             &localBase,
+                                             &nc->sharedWindow);
+    if (rc != MPI_SUCCESS)
+    {
+        /* Fall back to summing with MPI collectives */
+        nc->sharedWindow = MPI_WIN_NULL;
+        return;
+    }
+
+    MPI_Aint size      = 0;
+    int      dispUnit  = 0;
+    double*  rank0Base = nullptr;
+    MPI_Win_shared_query(nc->sharedWindow, 0, &size, &dispUnit, &rank0Base);
+    nc->sharedBuffer         = rank0Base;
+    nc->sharedBufferSlotSize = c_nodeSharedSumBufferSize;
+
+    /* Open a passive epoch for the lifetime of the window,
+     * we synchronize using MPI_Win_sync and barriers.
+     */
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, nc->sharedWindow);
+}
+
+//! Closes the epoch on and frees the shared-memory window, collective over the node
+static void freeNodeSharedSumBuffer(gmx_nodecomm_t* nc)
+{
+    if (nc->sharedWindow == MPI_WIN_NULL)
+    {
+        return;
+    }
+    MPI_Win_unlock_all(nc->sharedWindow);
+    MPI_Win_free(&nc->sharedWindow);
+    nc->sharedBuffer         = nullptr;
+    nc->sharedBufferSlotSize = 0;
+}
+
+/*! \brief Sums \p r over all ranks using shared memory within nodes
+ *
+ * All ranks copy their data into their own slot, then each rank sums
+ * a contiguous part of the elements over all slots into the result slot,
+ * so the reduction work is distributed over the ranks in the node.
+ * The intra-node rank 0 sums the result over the nodes. Using a separate
+ * result slot avoids the need for a barrier after the final copy-out,
+ * since the result slot is only written again after the first barrier
+ * of the next call.
+ */
+static void sumdUsingNodeSharedMemory(std::size_t nr, double r[], const gmx_nodecomm_t& nc)
+{
+    const std::size_t slotSize = nc.sharedBufferSlotSize;
+    double*           result   = nc.sharedBuffer + nc.size_intra * slotSize;
+
+    std::copy(r, r + nr, nc.sharedBuffer + nc.rank_intra * slotSize);
+
+    MPI_Win_sync(nc.sharedWindow);
+    MPI_Barrier(nc.comm_intra);
+    MPI_Win_sync(nc.sharedWindow);
+
+    const std::size_t start = (nr * nc.rank_intra) / nc.size_intra;
+    const std::size_t end   = (nr * (nc.rank_intra + 1)) / nc.size_intra;
+    std::copy(nc.sharedBuffer + start, nc.sharedBuffer + end, result + start);
+    for (int rank = 1; rank < nc.size_intra; rank++)
+    {
+        const double* slot = nc.sharedBuffer + rank * slotSize;
+        for (std::size_t i = start; i < end; i++)
+        {
+            result[i] += slot[i];
+        }
+    }
+
+    MPI_Win_sync(nc.sharedWindow);
+    MPI_Barrier(nc.comm_intra);
+    MPI_Win_sync(nc.sharedWindow);
+
+    if (nc.rank_intra == 0 && nc.numNodes > 1)
+    {
+        MPI_Allreduce(MPI_IN_PLACE, result, nr, MPI_DOUBLE, MPI_SUM, nc.comm_inter);
+        MPI_Win_sync(nc.sharedWindow);
+    }
+    if (nc.numNodes > 1)
+    {
+        MPI_Barrier(nc.comm_intra);
+        MPI_Win_sync(nc.sharedWindow);
+    }
+
+    std::copy(result, result + nr, r);
+}
+#endif
+
 void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
 {
     gmx_nodecomm_t* nc;
@@ -131,8 +248,17 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
     }
 
 
-    /* The intra-node communicator, split on node number */
+    /* The intra-node communicator, split on node number.
+     * With MPI-3 we let MPI determine which ranks share memory,
+     * which is exact, whereas the node hash could in principle collide.
+     */
+#        if GMX_NODECOMM_SHARED_MEMORY
+    GMX_UNUSED_VALUE(nodehash);
+    MPI_Comm_split_type(
+            cr->mpi_comm_mygroup, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nc->comm_intra);
+#        else
     MPI_Comm_split(cr->mpi_comm_mygroup, nodehash, rank, &nc->comm_intra);
+#        endif
     MPI_Comm_rank(nc->comm_intra, &nc->rank_intra);
     if (debug)
     {
@@ -153,15 +279,36 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
         fprintf(debug, "In gmx_setup_nodecomm: groups %d, my group size %d\n", ng, ni);
     }
 
-    if (getenv("GMX_NO_NODECOMM") == nullptr && ((ng > 1 && ng < n) || (ni > 1 && ni < n)))
+    /* With uneven numbers of ranks per node, comm_inter is smaller
+     * for ranks with higher rank_intra, so we count the intra-node
+     * roots to get the same number of nodes on all ranks.
+     */
+    int isNodeRoot = (nc->rank_intra == 0 ? 1 : 0);
+    int numNodes   = 0;
+    MPI_Allreduce(&isNodeRoot, &numNodes, 1, MPI_INT, MPI_SUM, cr->mpi_comm_mygroup);
+
+    if (getenv("GMX_NO_NODECOMM") == nullptr
+        && ((numNodes > 1 && numNodes < n) || (ni > 1 && ni < n)))
     {
-        nc->bUse = TRUE;
+        nc->bUse       = TRUE;
+        nc->size_intra = ni;
+        nc->numNodes   = numNodes;
+#        if GMX_NODECOMM_SHARED_MEMORY
+        /* Replace the intra-node reduce and broadcast of gmx_sumd
+         * by summation through shared memory.
+         */
+        if (getenv("GMX_NO_NODECOMM_SHARED_MEMORY") == nullptr && ni > 1)
+        {
+            setupNodeSharedSumBuffer(nc);
+        }
+#        endif
         if (fplog)
         {
             fprintf(fplog,
-                    "Using two step summing over %d groups of on average %.1f ranks\n\n",
-                    ng,
-                    real(n) / real(ng));
+                    "Using two step summing over %d groups of on average %.1f ranks%s\n\n",
+                    numNodes,
+                    real(n) / real(numNodes),
+                    nc->sharedBuffer ? ", summing within groups through shared memory" : "");
         }
         if (nc->rank_intra > 0)
         {
@@ -187,6 +334,28 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
 #endif
 }
 
+void gmx_done_nodecomm(t_commrec* cr)
+{
+#if GMX_MPI && !GMX_THREAD_MPI
+    gmx_nodecomm_t* nc = &cr->nc;
+    if (!nc->bUse)
+    {
+        return;
+    }
+#    if GMX_NODECOMM_SHARED_MEMORY
+    freeNodeSharedSumBuffer(nc);
+#    endif
+    if (nc->comm_inter != MPI_COMM_NULL)
+    {
+        MPI_Comm_free(&nc->comm_inter);
+    }
+    MPI_Comm_free(&nc->comm_intra);
+    nc->bUse = false;
+#else
+    GMX_UNUSED_VALUE(cr);
+#endif
+}
+
 void gmx_barrier(MPI_Comm gmx_unused communicator)
 {
     if (communicator == MPI_COMM_NULL)
@@ -225,6 +394,14 @@ void gmx_sumd(std::size_t gmx_unused nr, double gmx_unused r[], const t_commrec
         return;
     }
 
+#    if GMX_NODECOMM_SHARED_MEMORY
+    if (cr->nc.bUse && cr->nc.sharedBuffer && nr <= cr->nc.sharedBufferSlotSize)
+    {
+        sumdUsingNodeSharedMemory(nr, r, cr->nc);
+        return;
+    }
+#    endif
+
     constexpr std::size_t maxSignedInt = std::numeric_limits<int>::max();
     if (cr->nc.bUse)
     {
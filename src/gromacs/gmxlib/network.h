@@ -59,6 +59,10 @@ std::unique_ptr<t_commrec> init_commrec(MPI_Comm communicator);
 void gmx_setup_nodecomm(FILE* fplog, struct t_commrec* cr);
 /* Sets up fast global communication for clusters with multi-core nodes */
 
+void gmx_done_nodecomm(struct t_commrec* cr);
+/* Frees the communicators and shared memory set up by gmx_setup_nodecomm,
+ * collective over the ranks in cr->mpi_comm_mygroup */
+
 //! Wait until all processes in communicator have reached the barrier
 void gmx_barrier(MPI_Comm communicator);
 
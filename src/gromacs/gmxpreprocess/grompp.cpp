@@ -45,6 +45,7 @@
 #include <algorithm>
 #include <array>
 #include <filesystem>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -263,6 +264,69 @@ void InteractionOfType::setForceParameter(int pos, real value)
     forceParam_[pos] = value;
 }
 
+std::size_t AtomTypesHash::operator()(const std::vector<int>& atomTypes) const
+{
+    std::size_t hash = atomTypes.size();
+    for (const int atomType : atomTypes)
+    {
+        // Same combination as boost::hash_combine
+        hash ^= std::hash<int>()(atomType) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+int InteractionsOfType::findInteractionTypeIndex(gmx::ArrayRef<const int> atomTypes) const
+{
+    const auto matches = [this, atomTypes](std::size_t index) {
+        gmx::ArrayRef<const int> entryAtomTypes = interactionTypes[index].atoms();
+        return std::equal(
+                entryAtomTypes.begin(), entryAtomTypes.end(), atomTypes.begin(), atomTypes.end());
+    };
+    const auto updateIndex = [this](bool rebuild) {
+        if (rebuild || numIndexedInteractionTypes_ > interactionTypes.size())
+        {
+            atomTypesIndex_.clear();
+            numIndexedInteractionTypes_ = 0;
+        }
+        for (; numIndexedInteractionTypes_ < interactionTypes.size(); numIndexedInteractionTypes_++)
+        {
+            gmx::ArrayRef<const int> entryAtomTypes =
+                    interactionTypes[numIndexedInteractionTypes_].atoms();
+            // emplace does not replace existing keys, so the first matching entry is kept
+            atomTypesIndex_.emplace(std::vector<int>(entryAtomTypes.begin(), entryAtomTypes.end()),
+                                    numIndexedInteractionTypes_);
+        }
+    };
+
+    updateIndex(false);
+
+    const auto found = atomTypesIndex_.find(std::vector<int>(atomTypes.begin(), atomTypes.end()));
+    if (found != atomTypesIndex_.end() && matches(found->second))
+    {
+        return found->second;
+    }
+
+    /* The entry is missing or the index is stale, because entries have
+     * been replaced. Confirm with a linear search, which costs the same
+     * as the search the index replaces and only occurs for atom types
+     * without default parameters.
+     */
+    for (std::size_t index = 0; index < interactionTypes.size(); index++)
+    {
+        if (matches(index))
+        {
+            updateIndex(true);
+            return static_cast<int>(index);
+        }
+    }
+    if (found != atomTypesIndex_.end())
+    {
+        updateIndex(true);
+    }
+
+    return -1;
+}
+
 void MoleculeInformation::initMolInfo()
 {
     init_block(&mols);
@@ -35,7 +35,11 @@
 #ifndef GMX_GMXPREPROCESS_GROMPP_IMPL_H
 #define GMX_GMXPREPROCESS_GROMPP_IMPL_H
 
+#include <cstddef>
+
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "gromacs/gmxpreprocess/notset.h"
 #include "gromacs/topology/atoms.h"
@@ -124,6 +128,15 @@ private:
     std::string interactionTypeName_;
 };
 
+/*! \libinternal \brief
+ * Hash function for a list of atom types.
+ */
+struct AtomTypesHash
+{
+    //! Returns the hash of \p atomTypes.
+    std::size_t operator()(const std::vector<int>& atomTypes) const;
+};
+
 /*! \libinternal \brief
  * A set of interactions of a given type
  * (found in the enumeration in ifunc.h), complete with
@@ -152,6 +165,20 @@ struct InteractionsOfType
     std::size_t ncmap() const { return cmap.size(); }
     //! Number of elements in cmapAtomTypes.
     std::size_t nct() const { return cmapAtomTypes.size(); }
+    /*! \brief Returns the index of the first entry with atom types \p atomTypes, -1 when not found.
+     *
+     * Uses a hash index over the atom types of interactionTypes, which
+     * is extended with entries appended since the last call. Hits are
+     * checked against interactionTypes and misses are confirmed with
+     * a linear search, so the index is rebuilt when entries have been
+     * replaced, e.g. after clearing and refilling interactionTypes.
+     */
+    int findInteractionTypeIndex(gmx::ArrayRef<const int> atomTypes) const;
+
+    //! Hash index from atom types to the first matching entry in interactionTypes.
+    mutable std::unordered_map<std::vector<int>, int, AtomTypesHash> atomTypesIndex_;
+    //! The number of entries in interactionTypes that are present in atomTypesIndex_.
+    mutable std::size_t numIndexedInteractionTypes_ = 0;
 };
 
 struct t_excls
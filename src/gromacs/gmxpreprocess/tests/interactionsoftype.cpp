@@ -0,0 +1,118 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for looking up interaction types by atom types during preprocessing.
+ */
+#include "gmxpre.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxpreprocess/grompp_impl.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Appends an interaction type with atom types \p atomTypes and first parameter \p value
+void addInteractionType(InteractionsOfType*     interactions,
+                        const std::vector<int>& atomTypes,
+                        real                    value)
+{
+    const std::vector<real> forceParam = { value };
+    interactions->interactionTypes.emplace_back(atomTypes, forceParam);
+}
+
+TEST(InteractionsOfTypeTest, FindsFirstMatchingInteractionType)
+{
+    InteractionsOfType interactions;
+    addInteractionType(&interactions, { 0, 1, 2 }, 1);
+    addInteractionType(&interactions, { 2, 1, 0 }, 2);
+    addInteractionType(&interactions, { 0, 1, 2 }, 3);
+
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 0, 1, 2 }), 0);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 2, 1, 0 }), 1);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 1, 1, 2 }), -1);
+}
+
+TEST(InteractionsOfTypeTest, FindsInteractionTypesAddedAfterLookup)
+{
+    InteractionsOfType interactions;
+    addInteractionType(&interactions, { 0, 1 }, 1);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 3, 4 }), -1);
+
+    addInteractionType(&interactions, { 3, 4 }, 2);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 3, 4 }), 1);
+
+    interactions.interactionTypes.clear();
+    addInteractionType(&interactions, { 3, 4 }, 3);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 3, 4 }), 0);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 0, 1 }), -1);
+}
+
+TEST(InteractionsOfTypeTest, FindsInteractionTypesAfterClearAndRefill)
+{
+    InteractionsOfType interactions;
+    addInteractionType(&interactions, { 0, 1 }, 1);
+    addInteractionType(&interactions, { 2, 3 }, 2);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 0, 1 }), 0);
+
+    // Refill to the same size with the entries in a different order
+    interactions.interactionTypes.clear();
+    addInteractionType(&interactions, { 2, 3 }, 3);
+    addInteractionType(&interactions, { 0, 1 }, 4);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 0, 1 }), 1);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 2, 3 }), 0);
+
+    // Refill to a larger size with entries that were not indexed before
+    interactions.interactionTypes.clear();
+    addInteractionType(&interactions, { 4, 5 }, 5);
+    addInteractionType(&interactions, { 6, 7 }, 6);
+    addInteractionType(&interactions, { 2, 3 }, 7);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 0, 1 }), -1);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 6, 7 }), 1);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 4, 5 }), 0);
+    EXPECT_EQ(interactions.findInteractionTypeIndex(std::vector<int>{ 2, 3 }), 2);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -1861,14 +1861,14 @@ defaultInteractionsOfType(int                               ftype,
     }
     else /* Not a dihedral */
     {
-        auto found = std::find_if(
-                bondType[ftype].interactionTypes.begin(),
-                bondType[ftype].interactionTypes.end(),
-                [&atomTypes](const auto& param) {
-                    return std::equal(param.atoms().begin(), param.atoms().end(), atomTypes.begin());
-                });
-        if (found != bondType[ftype].interactionTypes.end())
+        /* Use the hash index instead of a linear search, as large
+         * systems look up the types of many bonds and angles
+         */
+        const int foundIndex = bondType[ftype].findInteractionTypeIndex(atomTypes);
+        auto      found      = bondType[ftype].interactionTypes.end();
+        if (foundIndex >= 0)
         {
+            found        = bondType[ftype].interactionTypes.begin() + foundIndex;
             nparam_found = 1;
         }
         *nparam_def = nparam_found;
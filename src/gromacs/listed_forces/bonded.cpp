@@ -2255,20 +2255,21 @@ rbdihs(int             nbonds,
 
 
 template<BondedKernelFlavor flavor>
-real idihs(int             nbonds,
-           const t_iatom   forceatoms[],
-           const t_iparams forceparams[],
-           const rvec      x[],
-           rvec4           f[],
-           rvec            fshift[],
-           const t_pbc*    pbc,
-           real            lambda,
-           real*           dvdlambda,
-           gmx::ArrayRef<const real> /*charge*/,
-           t_fcdata gmx_unused* fcd,
-           t_disresdata gmx_unused* disresdata,
-           t_oriresdata gmx_unused* oriresdata,
-           int gmx_unused* global_atom_index)
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec            fshift[],
+      const t_pbc*    pbc,
+      real            lambda,
+      real*           dvdlambda,
+      gmx::ArrayRef<const real> /*charge*/,
+      t_fcdata gmx_unused* fcd,
+      t_disresdata gmx_unused* disresdata,
+      t_oriresdata gmx_unused* oriresdata,
+      int gmx_unused* global_atom_index)
 {
     int  i, type, ai, aj, ak, al;
     int  t1, t2, t3;
@@ -2324,6 +2325,112 @@ real idihs(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As idihs above, but using SIMD to calculate multiple dihedrals at once */
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec gmx_unused fshift[],
+      const t_pbc*    pbc,
+      real gmx_unused lambda,
+      real gmx_unused* dvdlambda,
+      gmx::ArrayRef<const real> /*charge*/,
+      t_fcdata gmx_unused* fcd,
+      t_disresdata gmx_unused* disresdata,
+      t_oriresdata gmx_unused* oriresdata,
+      int gmx_unused* global_atom_index)
+{
+    const int                                nfa1 = 5;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t al[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         coeff[2 * GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+
+    const SimdReal deg2rad_S(gmx::c_deg2Rad);
+    const SimdReal pi_S(M_PI);
+    const SimdReal twoPi_S(2 * M_PI);
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    /* nbonds is the number of dihedrals times nfa1, here we step GMX_SIMD_REAL_WIDTH dihs */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms quadruplets for GMX_SIMD_REAL_WIDTH dihedrals.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            ak[s]          = forceatoms[iu + 3];
+            al[s]          = forceatoms[iu + 4];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                coeff[s]                       = forceparams[type].harmonic.krA;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = forceparams[type].harmonic.rA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                coeff[s]                       = 0;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = 0;
+            }
+        }
+
+        SimdReal phi_S, mx_S, my_S, mz_S, nx_S, ny_S, nz_S, nrkj_m2_S, nrkj_n2_S, p_S, q_S;
+
+        /* Calculate GMX_SIMD_REAL_WIDTH dihedral angles at once */
+        dih_angle_simd(
+                x, ai, aj, ak, al, pbc_simd, &phi_S, &mx_S, &my_S, &mz_S, &nx_S, &ny_S, &nz_S, &nrkj_m2_S, &nrkj_n2_S, &p_S, &q_S);
+
+        const SimdReal k_S    = load<SimdReal>(coeff);
+        const SimdReal phi0_S = load<SimdReal>(coeff + GMX_SIMD_REAL_WIDTH) * deg2rad_S;
+
+        /* As make_dp_periodic(), put dp in the range [-pi,pi) */
+        SimdReal dp_S = phi_S - phi0_S;
+        dp_S          = dp_S - selectByMask(twoPi_S, pi_S <= dp_S);
+        dp_S          = dp_S + selectByMask(twoPi_S, dp_S < -pi_S);
+
+        /* This is ddphi of the plain-C code, which passes -ddphi to do_dih_fup().
+         * So it plays the role of mddphi_S in the proper dihedral SIMD kernel.
+         */
+        const SimdReal ddphi_S = -k_S * dp_S;
+        const SimdReal sf_i_S  = ddphi_S * nrkj_m2_S;
+        const SimdReal msf_l_S = ddphi_S * nrkj_n2_S;
+
+        /* After this m?_S will contain f[i] */
+        mx_S = sf_i_S * mx_S;
+        my_S = sf_i_S * my_S;
+        mz_S = sf_i_S * mz_S;
+
+        /* After this m?_S will contain -f[l] */
+        nx_S = msf_l_S * nx_S;
+        ny_S = msf_l_S * ny_S;
+        nz_S = msf_l_S * nz_S;
+
+        do_dih_fup_noshiftf_simd(ai, aj, ak, al, p_S, q_S, mx_S, my_S, mz_S, nx_S, ny_S, nz_S, f);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 /*! \brief Computes angle restraints of two different types */
 template<BondedKernelFlavor flavor>
 real low_angres(int             nbonds,
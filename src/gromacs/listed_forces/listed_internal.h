@@ -95,6 +95,8 @@ struct bonded_threading_t
 
     //! Number of threads to be used for bondeds
     int nthreads = 0;
+    //! The log file, can be nullptr
+    FILE* logFile = nullptr;
     //! The thread parallel force and energy buffers
     gmx::ThreadedForceBuffer<rvec4> threadedForceBuffer;
     //! true if we have and thus need to reduce bonded forces
@@ -112,6 +114,11 @@ struct bonded_threading_t
     //! Work division for free-energy foreign lambda calculations, always uses 1 thread
     WorkDivision foreignLambdaWorkDivision;
 
+    //! The load imbalance of workDivision, based on modelled costs per interaction type
+    double modelledImbalance = 0;
+    //! Whether the modelled imbalance has been reported in the log file
+    bool haveReportedImbalance = false;
+
     GMX_DISALLOW_COPY_MOVE_AND_ASSIGN(bonded_threading_t);
 };
 
@@ -53,9 +53,12 @@
 #include <algorithm>
 #include <array>
 #include <filesystem>
+#include <numeric>
 #include <string>
 #include <vector>
 
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/listed_forces/bonded.h"
 #include "gromacs/listed_forces/listed_forces_gpu.h"
 #include "gromacs/mdtypes/threaded_force_buffer.h"
 #include "gromacs/pbcutil/ishift.h"
@@ -76,8 +79,24 @@ typedef struct
     const InteractionList* il;    /**< pointer to t_ilist entry corresponding to ftype */
     int                    ftype; /**< the function type index */
     int                    nat;   /**< nr of atoms involved in a single ftype interaction */
+    int                    cost;  /**< the modelled cost of a single ftype interaction */
 } ilist_data_t;
 
+/*! \brief Returns the modelled computational cost of one interaction of type \p ftype
+ *
+ * We use the flop count of the interaction, which is a reasonable
+ * measure for the relative cost of the bonded interaction types.
+ * For example, a CMAP is about 30 times as expensive as a bond.
+ */
+static int bondedInteractionCost(int ftype)
+{
+    const int nrnbIndexOfType = nrnbIndex(ftype);
+    const int cost            = (nrnbIndexOfType >= 0 ? cost_nrnb(nrnbIndexOfType) : 0);
+
+    /* Fall back to the number of atoms when no cost is available */
+    return (cost > 0 ? cost : NRAL(ftype));
+}
+
 /*! \brief Divides listed interactions over threads
  *
  * This routine attempts to divide all interactions of the numType bondeds
@@ -87,18 +106,18 @@ typedef struct
  */
 static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, const ilist_data_t* ild)
 {
-    int nat_tot, nat_sum;
-    int ind[F_NRE];    /* index into the ild[].il->iatoms */
-    int at_ind[F_NRE]; /* index of the first atom of the interaction at ind */
-    int f, t;
+    int64_t cost_tot, cost_sum;
+    int     ind[F_NRE];    /* index into the ild[].il->iatoms */
+    int     at_ind[F_NRE]; /* index of the first atom of the interaction at ind */
+    int     f, t;
 
     assert(numType <= F_NRE);
 
-    nat_tot = 0;
+    cost_tot = 0;
     for (f = 0; f < numType; f++)
     {
-        /* Sum #bondeds*#atoms_per_bond over all bonded types */
-        nat_tot += ild[f].il->size() / (ild[f].nat + 1) * ild[f].nat;
+        /* Sum #bondeds*cost_per_bond over all bonded types */
+        cost_tot += static_cast<int64_t>(ild[f].il->size() / (ild[f].nat + 1)) * ild[f].cost;
         /* The start bound for thread 0 is 0 for all interactions */
         ind[f] = 0;
         /* Initialize the next atom index array */
@@ -106,7 +125,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
         at_ind[f] = ild[f].il->iatoms[1];
     }
 
-    nat_sum = 0;
+    cost_sum = 0;
     /* Loop over the end bounds of the nthreads threads to determine
      * which interactions threads 0 to nthreads shall calculate.
      *
@@ -120,18 +139,13 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
      */
     for (t = 1; t <= bt->nthreads; t++)
     {
-        int nat_thread;
-
-        /* Here we assume that the computational cost is proportional
-         * to the number of atoms in the interaction. This is a rough
-         * measure, but roughly correct. Usually there are very few
-         * interactions anyhow and there are distributed relatively
-         * uniformly. Proper and RB dihedrals are often distributed
-         * non-uniformly, but their cost is roughly equal.
+        /* Here we use the modelled cost per interaction type, so that
+         * expensive types, such as CMAP, are not weighted the same as
+         * cheap types, such as bonds.
          */
-        nat_thread = (nat_tot * t) / bt->nthreads;
+        const int64_t cost_thread = (cost_tot * t) / bt->nthreads;
 
-        while (nat_sum < nat_thread)
+        while (cost_sum < cost_thread)
         {
             /* To divide bonds based on atom order, we compare
              * the index of the first atom in the bonded interaction.
@@ -161,7 +175,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
              * index f_min) to thread t-1 by increasing ind.
              */
             ind[f_min] += ild[f_min].nat + 1;
-            nat_sum += ild[f_min].nat;
+            cost_sum += ild[f_min].cost;
 
             /* Update the first unassigned atom index for this type */
             if (ind[f_min] < ild[f_min].il->size())
@@ -292,6 +306,7 @@ static void divide_bondeds_over_threads(bonded_threading_t*           bt,
             ild[numType].ftype = fType;
             ild[numType].il    = &il;
             ild[numType].nat   = nat;
+            ild[numType].cost  = bondedInteractionCost(fType);
 
             /* The first index for the thread division is always 0 */
             bt->workDivision.setBound(fType, 0, 0);
@@ -305,11 +320,50 @@ static void divide_bondeds_over_threads(bonded_threading_t*           bt,
         divide_bondeds_by_locality(bt, numType, ild);
     }
 
+    /* Compute the modelled load imbalance of the division */
+    std::vector<int64_t> threadCost(numThreads, 0);
+    for (int fType = 0; fType < F_NRE; fType++)
+    {
+        if (ftype_is_bonded_potential(fType) && !idef.il[fType].empty())
+        {
+            const int stride = 1 + NRAL(fType);
+            const int cost   = bondedInteractionCost(fType);
+            for (int t = 0; t < numThreads; t++)
+            {
+                const int numInteractions = (bt->workDivision.bound(fType, t + 1)
+                                             - bt->workDivision.bound(fType, t))
+                                            / stride;
+                threadCost[t] += static_cast<int64_t>(numInteractions) * cost;
+            }
+        }
+    }
+    const int64_t costMax = *std::max_element(threadCost.begin(), threadCost.end());
+    const int64_t costSum = std::accumulate(threadCost.begin(), threadCost.end(), int64_t(0));
+    bt->modelledImbalance =
+            (costSum > 0 ? (costMax * numThreads) / static_cast<double>(costSum) - 1 : 0);
+
+    if (bt->logFile != nullptr && !bt->haveReportedImbalance && bt->haveBondeds && numThreads > 1)
+    {
+        /* With few threads all types are divided uniformly, otherwise
+         * the cost-weighted division by locality is used for most types.
+         */
+        fprintf(bt->logFile,
+                "\nListed interactions are distributed over %d threads %s,\nthe modelled load "
+                "imbalance is %.1f%%\n",
+                numThreads,
+                numType > 0 ? "by locality using modelled costs per interaction type"
+                            : "using equal numbers of interactions per type",
+                100 * bt->modelledImbalance);
+        bt->haveReportedImbalance = true;
+    }
+
     if (debug)
     {
         int f;
 
-        fprintf(debug, "Division of bondeds over threads:\n");
+        fprintf(debug,
+                "Division of bondeds over threads, modelled load imbalance %.1f%%:\n",
+                100 * bt->modelledImbalance);
         for (f = 0; f < F_NRE; f++)
         {
             if (ftype_is_bonded_potential(f) && !idef.il[f].empty())
@@ -416,6 +470,7 @@ void setup_bonded_threading(bonded_threading_t*           bt,
 
 bonded_threading_t::bonded_threading_t(const int numThreads, const int numEnergyGroups, FILE* fplog) :
     nthreads(numThreads),
+    logFile(fplog),
     threadedForceBuffer(numThreads, true, numEnergyGroups),
     haveBondeds(false),
     workDivision(nthreads),
@@ -1190,6 +1190,8 @@ Constraints::Impl::Impl(const gmx_mtop_t&          mtop_p,
             }
 
             shaked = std::make_unique<shakedata>();
+            // SHAKE uses the thread count of the LINCS module
+            shaked->numThreads = gmx_omp_nthreads_get(ModuleMultiThread::Lincs);
         }
     }
 
@@ -40,9 +40,16 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <condition_variable>
+#include <exception>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/collect.h"
@@ -85,10 +92,301 @@
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/sysinfo.h"
 
+namespace gmx
+{
+
+//! A compressed-position frame for XTC output
+struct XtcFrame
+{
+    //! The MD step
+    int64_t step = 0;
+    //! The time
+    double time = 0;
+    //! The box
+    matrix box = { { 0 } };
+    //! The coordinates
+    std::vector<RVec> x;
+};
+
+//! A frame for TNG output, empty vectors are not written
+struct TngFrame
+{
+    //! Whether to use lossy compression for the coordinates
+    bool useLossyCompression = false;
+    //! The MD step
+    int64_t step = 0;
+    //! The time
+    double time = 0;
+    //! The lambda value, not written when negative
+    real lambda = -1;
+    //! Whether to write the box
+    bool haveBox = false;
+    //! The box
+    matrix box = { { 0 } };
+    //! The number of atoms in the output
+    int numAtoms = 0;
+    //! The coordinates
+    std::vector<RVec> x;
+    //! The velocities
+    std::vector<RVec> v;
+    //! The forces
+    std::vector<RVec> f;
+};
+
+/*! \brief Writes trajectory frames on a background thread
+ *
+ * The frame passed to write() is copied, so the MD loop can continue while
+ * the frame is compressed and written. One frame can be pending while another
+ * is being written. When write() is called while a frame is still pending,
+ * it waits until the writer thread has taken that frame.
+ *
+ * Errors on the writer thread are reported to the calling thread, either as
+ * a false return value or by rethrowing the exception thrown by the writer.
+ *
+ * \tparam Frame  The frame type, its buffers are reused between frames
+ */
+template<typename Frame>
+class AsyncTrajectoryWriter
+{
+public:
+    //! Writes a frame to file, returns false on failure
+    using FrameWriter = std::function<bool(const Frame&)>;
+
+    //! Constructor, starts the writer thread that writes frames with \p writeFrame
+    explicit AsyncTrajectoryWriter(FrameWriter writeFrame) :
+        writeFrame_(std::move(writeFrame)), thread_([this]() { run(); })
+    {
+    }
+
+    //! Writes the remaining frames and stops the writer thread
+    ~AsyncTrajectoryWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        thread_.join();
+    }
+
+    /*! \brief Queues a frame for writing, returns false when writing of an earlier frame failed
+     *
+     * \p fillFrame should copy all data of the frame into the frame buffer it is passed.
+     * Rethrows an exception thrown while writing an earlier frame.
+     */
+    bool write(const std::function<void(Frame*)>& fillFrame, gmx_wallcycle* wcycle)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wallcycle_start(wcycle, WallCycleCounter::TrajWriterWait);
+        condition_.wait(lock, [this]() { return !havePendingFrame_; });
+        wallcycle_stop(wcycle, WallCycleCounter::TrajWriterWait);
+        rethrowWriteException();
+
+        fillFrame(&pendingFrame_);
+        havePendingFrame_       = true;
+        const bool noWriteError = !writeFailed_;
+        lock.unlock();
+        condition_.notify_all();
+
+        return noWriteError;
+    }
+
+    /*! \brief Waits until all queued frames have been written, returns false when writing failed
+     *
+     * Rethrows an exception thrown by the writer.
+     */
+    bool waitForCompletion(gmx_wallcycle* wcycle)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wallcycle_start(wcycle, WallCycleCounter::TrajWriterWait);
+        condition_.wait(lock, [this]() { return !havePendingFrame_ && !isWriting_; });
+        wallcycle_stop(wcycle, WallCycleCounter::TrajWriterWait);
+        rethrowWriteException();
+
+        return !writeFailed_;
+    }
+
+private:
+    //! Rethrows an exception from the writer thread once, should be called with mutex_ locked
+    void rethrowWriteException()
+    {
+        if (writeException_)
+        {
+            std::rethrow_exception(std::exchange(writeException_, nullptr));
+        }
+    }
+
+    //! The writer thread loop
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            condition_.wait(lock, [this]() { return havePendingFrame_ || stop_; });
+            if (!havePendingFrame_)
+            {
+                break;
+            }
+            std::swap(pendingFrame_, writingFrame_);
+            havePendingFrame_ = false;
+            isWriting_        = true;
+            lock.unlock();
+            condition_.notify_all();
+
+            bool               writeOK = false;
+            std::exception_ptr exception;
+            try
+            {
+                writeOK = writeFrame_(writingFrame_);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            lock.lock();
+            isWriting_ = false;
+            if (!writeOK)
+            {
+                writeFailed_ = true;
+            }
+            if (exception && !writeException_)
+            {
+                writeException_ = exception;
+            }
+            condition_.notify_all();
+        }
+    }
+
+    //! Writes a frame to file
+    FrameWriter writeFrame_;
+    //! Protects all data below
+    std::mutex mutex_;
+    //! Signals changes in the state of the frame buffers
+    std::condition_variable condition_;
+    //! The pending frame
+    Frame pendingFrame_;
+    //! The frame being written
+    Frame writingFrame_;
+    //! Whether there is a frame waiting to be written
+    bool havePendingFrame_ = false;
+    //! Whether a frame is being written
+    bool isWriting_ = false;
+    //! Whether the writer thread should stop when it has no pending frame
+    bool stop_ = false;
+    //! Whether writing a frame failed
+    bool writeFailed_ = false;
+    //! An exception thrown by the writer, not yet rethrown
+    std::exception_ptr writeException_;
+    //! The writer thread, should be initialized last
+    std::thread thread_;
+};
+
+//! Writes XTC frames on a background thread
+using AsyncXtcWriter = AsyncTrajectoryWriter<XtcFrame>;
+//! Writes TNG frames on a background thread
+using AsyncTngWriter = AsyncTrajectoryWriter<TngFrame>;
+
+/*! \brief Finishes writing checkpoint files on a background thread
+ *
+ * The checkpoint data is written to a temporary file by the MD thread.
+ * Syncing that file and all output files to disk, backing up the previous
+ * checkpoint and renaming the temporary file often take much longer and
+ * are done on a background thread, so the MD loop can continue. Only one
+ * checkpoint is finalized at a time.
+ *
+ * Fatal file errors can only be issued on the MD thread, so the finalize
+ * function returns the error message, which is issued by waitForCompletion().
+ */
+class CheckpointFinalizer
+{
+public:
+    //! Waits for the last checkpoint to be finalized
+    ~CheckpointFinalizer()
+    {
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    /*! \brief Waits for the previous checkpoint, then runs \p finalize on a background thread
+     *
+     * \p finalize should return an empty string on success, an error message otherwise.
+     */
+    void launch(std::function<std::string()> finalize, gmx_wallcycle* wcycle)
+    {
+        waitForCompletion(wcycle);
+        thread_ = std::thread([this, finalize = std::move(finalize)]() {
+            try
+            {
+                errorMessage_ = finalize();
+            }
+            catch (...)
+            {
+                exception_ = std::current_exception();
+            }
+        });
+    }
+
+    /*! \brief Waits until the last checkpoint has been finalized
+     *
+     * Rethrows an exception thrown while finalizing and issues a fatal error
+     * when finalizing failed.
+     */
+    void waitForCompletion(gmx_wallcycle* wcycle)
+    {
+        if (!thread_.joinable())
+        {
+            return;
+        }
+        wallcycle_start(wcycle, WallCycleCounter::CheckpointWait);
+        thread_.join();
+        wallcycle_stop(wcycle, WallCycleCounter::CheckpointWait);
+        if (exception_)
+        {
+            std::rethrow_exception(std::exchange(exception_, nullptr));
+        }
+        if (!errorMessage_.empty())
+        {
+            gmx_file(errorMessage_);
+        }
+    }
+
+private:
+    //! The thread finalizing the last checkpoint
+    std::thread thread_;
+    //! An exception thrown while finalizing, only accessed after joining the thread
+    std::exception_ptr exception_;
+    //! The error message from finalizing, only accessed after joining the thread
+    std::string errorMessage_;
+};
+
+} // namespace gmx
+
+//! Issues a fatal error for failed XTC output
+static void xtcWriteError()
+{
+    gmx_fatal(FARGS,
+              "XTC error. This indicates you are out of disk space, or a "
+              "simulation with major instabilities resulting in coordinates "
+              "that are NaN or too large to be represented in the XTC format.\n");
+}
+
+//! Issues a fatal error for failed compressed TNG output, as gmx_fwrite_tng() does
+static void tngWriteError()
+{
+    gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+}
+
 struct gmx_mdoutf
 {
     t_fileio*                      fp_trn;
     t_fileio*                      fp_xtc;
+    gmx::AsyncXtcWriter*           xtcWriter;           /* XTC writer thread, can be nullptr */
+    gmx::AsyncTngWriter*           tngLowPrecWriter;    /* TNG writer thread, can be nullptr */
+    gmx::CheckpointFinalizer*      checkpointFinalizer; /* checkpoint thread, can be nullptr */
+    FILE*                          fp_xtc_index;        /* XTC frame index, can be nullptr */
     gmx_tng_trajectory_t           tng;
     gmx_tng_trajectory_t           tng_low_prec;
     int                            x_compression_precision; /* only used by XTC output */
@@ -135,12 +433,16 @@ gmx_mdoutf_t init_mdoutf(FILE*                          fplog,
 
     snew(of, 1);
 
-    of->fp_trn       = nullptr;
-    of->fp_ene       = nullptr;
-    of->fp_xtc       = nullptr;
-    of->tng          = nullptr;
-    of->tng_low_prec = nullptr;
-    of->fp_dhdl      = nullptr;
+    of->fp_trn              = nullptr;
+    of->fp_ene              = nullptr;
+    of->fp_xtc              = nullptr;
+    of->xtcWriter           = nullptr;
+    of->tngLowPrecWriter    = nullptr;
+    of->checkpointFinalizer = nullptr;
+    of->fp_xtc_index        = nullptr;
+    of->tng                 = nullptr;
+    of->tng_low_prec        = nullptr;
+    of->fp_dhdl             = nullptr;
 
     of->eIntegrator             = ir->eI;
     of->bExpanded               = ir->bExpanded;
@@ -163,6 +465,19 @@ gmx_mdoutf_t init_mdoutf(FILE*                          fplog,
     {
         of->bKeepAndNumCPT = mdrunOptions.checkpointOptions.keepAndNumberCheckpointFiles;
 
+        /* The MPI barrier for simulations that share state can only be
+         * called from the MD thread, and the FAH checkpoint should follow
+         * the GROMACS checkpoint directly.
+         */
+        if (getenv("GMX_ASYNC_CHECKPOINT") != nullptr && !of->simulationsShareState && !GMX_FAHCORE)
+        {
+            of->checkpointFinalizer = new gmx::CheckpointFinalizer;
+            if (fplog)
+            {
+                fprintf(fplog, "Will finish writing checkpoint files on a separate thread\n");
+            }
+        }
+
         filemode = restartWithAppending ? appendMode : writeMode;
 
         if (EI_DYNAMICS(ir->eI) && ir->nstxout_compressed > 0)
@@ -171,13 +486,73 @@ gmx_mdoutf_t init_mdoutf(FILE*                          fplog,
             filename = ftp2fn(efCOMPRESSED, nfile, fnm);
             switch (fn2ftp(filename))
             {
-                case efXTC: of->fp_xtc = open_xtc(filename, filemode); break;
+                case efXTC:
+                    of->fp_xtc = open_xtc(filename, filemode);
+                    if (getenv("GMX_XTC_FRAME_INDEX") != nullptr)
+                    {
+                        of->fp_xtc_index =
+                                open_xtc_frame_index(filename, restartWithAppending ? "a" : "w");
+                    }
+                    if (getenv("GMX_ASYNC_XTC_OUTPUT") != nullptr)
+                    {
+                        of->xtcWriter = new gmx::AsyncXtcWriter(
+                                [fio        = of->fp_xtc,
+                                 precision  = of->x_compression_precision,
+                                 frameIndex = of->fp_xtc_index](const gmx::XtcFrame& frame) {
+                                    const gmx_off_t offset  = gmx_fio_ftell(fio);
+                                    const bool      writeOK = (write_xtc(fio,
+                                                                    gmx::ssize(frame.x),
+                                                                    frame.step,
+                                                                    frame.time,
+                                                                    frame.box,
+                                                                    as_rvec_array(frame.x.data()),
+                                                                    precision)
+                                                          != 0);
+                                    if (writeOK && frameIndex)
+                                    {
+                                        write_xtc_frame_index_entry(
+                                                frameIndex,
+                                                { offset, frame.step, static_cast<real>(frame.time) });
+                                    }
+                                    return writeOK;
+                                });
+                        if (fplog)
+                        {
+                            fprintf(fplog, "Will write XTC frames on a separate thread\n");
+                        }
+                    }
+                    break;
                 case efTNG:
                     gmx_tng_open(filename, filemode[0], &of->tng_low_prec);
                     if (filemode[0] == 'w')
                     {
                         gmx_tng_prepare_low_prec_writing(of->tng_low_prec, &top_global, ir);
                     }
+                    if (getenv("GMX_ASYNC_TNG_OUTPUT") != nullptr)
+                    {
+                        of->tngLowPrecWriter = new gmx::AsyncTngWriter(
+                                [tng = of->tng_low_prec](const gmx::TngFrame& frame) {
+                                    /* Failures are reported on the main thread */
+                                    const auto vectors = [](const std::vector<gmx::RVec>& v) {
+                                        return v.empty() ? nullptr : as_rvec_array(v.data());
+                                    };
+                                    return gmx_tng_write_frame(tng,
+                                                               frame.useLossyCompression,
+                                                               frame.step,
+                                                               frame.time,
+                                                               frame.lambda,
+                                                               frame.haveBox ? frame.box : nullptr,
+                                                               frame.numAtoms,
+                                                               vectors(frame.x),
+                                                               vectors(frame.v),
+                                                               vectors(frame.f));
+                                });
+                        if (fplog)
+                        {
+                            fprintf(fplog,
+                                    "Will write compressed TNG frames on a separate thread\n");
+                        }
+                    }
                     bCiteTng = TRUE;
                     break;
                 default: gmx_incons("Invalid reduced precision file format");
@@ -290,10 +665,122 @@ static void mpiBarrierBeforeRename(const bool applyMpiBarrierBeforeRename, MPI_C
 #endif
     }
 }
+
+/*! \brief Syncs the checkpoint file \p fp with name \p fntemp and all output files to disk
+ *
+ * Then closes \p fp and renames \p fntemp to \p fn, unless \p bNumberAndKeep is set, after
+ * backing up a previous checkpoint with the suffix _prev.cpt.
+ * Does not issue fatal errors, so it can run on a background thread.
+ *
+ * \returns An empty string on success, otherwise the message for a fatal file error
+ */
+static std::string finish_checkpoint(t_fileio*   fp,
+                              const char* fn,
+                              const char* fntemp,
+                              gmx_bool    bNumberAndKeep,
+                              bool        applyMpiBarrierBeforeRename,
+                              MPI_Comm    mpiBarrierCommunicator)
+{
+    t_fileio* ret;
+
+    /* we really, REALLY, want to make sure to physically write the checkpoint,
+       and all the files it depends on, out to disk. Because we've
+       opened the checkpoint with gmx_fio_open(), it's in our list
+       of open files.  */
+    ret = gmx_fio_all_output_fsync();
+
+    if (ret)
+    {
+        char buf[STRLEN];
+        sprintf(buf,
+                "Cannot fsync '%s'; maybe you are out of disk space?",
+                gmx_fio_getname(ret).string().c_str());
+
+        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
+        {
+            return buf;
+        }
+        else
+        {
+            gmx_warning("%s", buf);
+        }
+    }
+
+    if (gmx_fio_close(fp) != 0)
+    {
+        return "Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?";
+    }
+
+    /* we don't move the checkpoint if the user specified they didn't want it,
+       or if the fsyncs failed */
+#if !GMX_NO_RENAME
+    if (!bNumberAndKeep && !ret)
+    {
+        char buf[1024];
+
+        // Add a barrier before renaming to reduce chance to get out of sync (#2440)
+        // Note: Checkpoint might only exist on some ranks, so put barrier before if clause (#3919)
+        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+        if (gmx_fexist(fn))
+        {
+            /* Rename the previous checkpoint file */
+            std::strcpy(buf, fn);
+            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
+            std::strcat(buf, "_prev");
+            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
+            if (!GMX_FAHCORE)
+            {
+                /* we copy here so that if something goes wrong between now and
+                 * the rename below, there's always a state.cpt.
+                 * If renames are atomic (such as in POSIX systems),
+                 * this copying should be unneccesary.
+                 */
+                if (gmx_file_copy(fn, buf, FALSE) != 0)
+                {
+                    GMX_THROW(gmx::FileIOError(
+                            gmx::formatString("Cannot rename checkpoint file from %s to %s; maybe "
+                                              "you are out of disk space?",
+                                              fn,
+                                              buf)));
+                }
+            }
+            else
+            {
+                gmx_file_rename(fn, buf);
+            }
+        }
+
+        /* Rename the checkpoint file from the temporary to the final name */
+        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+        try
+        {
+            gmx_file_rename(fntemp, fn);
+        }
+        catch (gmx::FileIOError const&)
+        {
+            // In this case we can be more helpful than the generic message from gmx_file_rename
+            GMX_THROW(gmx::FileIOError(
+                    "Cannot rename checkpoint file; maybe you are out of disk space?"));
+        }
+    }
+#else
+    GMX_UNUSED_VALUE(fn);
+    GMX_UNUSED_VALUE(fntemp);
+    GMX_UNUSED_VALUE(bNumberAndKeep);
+    GMX_UNUSED_VALUE(applyMpiBarrierBeforeRename);
+    GMX_UNUSED_VALUE(mpiBarrierCommunicator);
+#endif /* GMX_NO_RENAME */
+
+    return {};
+}
+
 /*! \brief Write a checkpoint to the filename
  *
  * Appends the _step<step>.cpt with bNumberAndKeep, otherwise moves
  * the previous checkpoint filename with suffix _prev.cpt.
+ * When \p finalizer is not nullptr, syncing and renaming the files is done
+ * on a background thread after this function returns.
  */
 static void write_checkpoint(const char*                     fn,
                              gmx_bool                        bNumberAndKeep,
@@ -312,13 +799,14 @@ static void write_checkpoint(const char*                     fn,
                              const gmx::MDModulesNotifiers&  mdModulesNotifiers,
                              gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData,
                              bool                            applyMpiBarrierBeforeRename,
-                             MPI_Comm                        mpiBarrierCommunicator)
+                             MPI_Comm                        mpiBarrierCommunicator,
+                             gmx::CheckpointFinalizer*       finalizer,
+                             gmx_wallcycle*                  wcycle)
 {
     t_fileio* fp;
     char*     fntemp; /* the temporary checkpoint file name */
     int       npmenodes;
     char      buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
-    t_fileio* ret;
 
     if (haveDDAtomOrdering(*cr))
     {
@@ -416,86 +904,30 @@ static void write_checkpoint(const char*                     fn,
                           &outputfiles,
                           modularSimulatorCheckpointData);
 
-    /* we really, REALLY, want to make sure to physically write the checkpoint,
-       and all the files it depends on, out to disk. Because we've
-       opened the checkpoint with gmx_fio_open(), it's in our list
-       of open files.  */
-    ret = gmx_fio_all_output_fsync();
-
-    if (ret)
-    {
-        char buf[STRLEN];
-        sprintf(buf,
-                "Cannot fsync '%s'; maybe you are out of disk space?",
-                gmx_fio_getname(ret).string().c_str());
-
-        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
-        {
-            gmx_file(buf);
-        }
-        else
-        {
-            gmx_warning("%s", buf);
-        }
-    }
-
-    if (gmx_fio_close(fp) != 0)
+    if (finalizer)
     {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        const std::string fileName     = fn;
+        const std::string tempFileName = fntemp;
+        finalizer->launch(
+                [=]() {
+                    return finish_checkpoint(fp,
+                                             fileName.c_str(),
+                                             tempFileName.c_str(),
+                                             bNumberAndKeep,
+                                             applyMpiBarrierBeforeRename,
+                                             mpiBarrierCommunicator);
+                },
+                wcycle);
     }
-
-    /* we don't move the checkpoint if the user specified they didn't want it,
-       or if the fsyncs failed */
-#if !GMX_NO_RENAME
-    if (!bNumberAndKeep && !ret)
+    else
     {
-        // Add a barrier before renaming to reduce chance to get out of sync (#2440)
-        // Note: Checkpoint might only exist on some ranks, so put barrier before if clause (#3919)
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-        if (gmx_fexist(fn))
-        {
-            /* Rename the previous checkpoint file */
-            std::strcpy(buf, fn);
-            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
-            std::strcat(buf, "_prev");
-            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
-            if (!GMX_FAHCORE)
-            {
-                /* we copy here so that if something goes wrong between now and
-                 * the rename below, there's always a state.cpt.
-                 * If renames are atomic (such as in POSIX systems),
-                 * this copying should be unneccesary.
-                 */
-                if (gmx_file_copy(fn, buf, FALSE) != 0)
-                {
-                    GMX_THROW(gmx::FileIOError(
-                            gmx::formatString("Cannot rename checkpoint file from %s to %s; maybe "
-                                              "you are out of disk space?",
-                                              fn,
-                                              buf)));
-                }
-            }
-            else
-            {
-                gmx_file_rename(fn, buf);
-            }
-        }
-
-        /* Rename the checkpoint file from the temporary to the final name */
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-        try
+        const std::string errorMessage = finish_checkpoint(
+                fp, fn, fntemp, bNumberAndKeep, applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+        if (!errorMessage.empty())
         {
-            gmx_file_rename(fntemp, fn);
-        }
-        catch (gmx::FileIOError const&)
-        {
-            // In this case we can be more helpful than the generic message from gmx_file_rename
-            GMX_THROW(gmx::FileIOError(
-                    "Cannot rename checkpoint file; maybe you are out of disk space?"));
+            gmx_file(errorMessage);
         }
     }
-#endif /* GMX_NO_RENAME */
 
     sfree(fntemp);
 
@@ -526,6 +958,21 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
                              ObservablesHistory*             observablesHistory,
                              gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData)
 {
+    /* The output file positions and checksums can only be read after the
+     * previous checkpoint has been synced to disk */
+    if (of->checkpointFinalizer)
+    {
+        of->checkpointFinalizer->waitForCompletion(of->wcycle);
+    }
+    /* The checkpoint stores the output file positions, so all frames should be written */
+    if (of->xtcWriter && !of->xtcWriter->waitForCompletion(of->wcycle))
+    {
+        xtcWriteError();
+    }
+    if (of->tngLowPrecWriter && !of->tngLowPrecWriter->waitForCompletion(of->wcycle))
+    {
+        tngWriteError();
+    }
     fflush_tng(of->tng);
     fflush_tng(of->tng_low_prec);
     /* Write the checkpoint file.
@@ -551,7 +998,99 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
                      *(of->mdModulesNotifiers),
                      modularSimulatorCheckpointData,
                      of->simulationsShareState,
-                     of->mainRanksComm);
+                     of->mainRanksComm,
+                     of->checkpointFinalizer,
+                     of->wcycle);
+}
+
+/*! \brief Writes a frame to the compressed TNG file, on the writer thread when present
+ *
+ * Arguments are as for gmx_fwrite_tng().
+ */
+static void write_tng_low_prec(gmx_mdoutf_t of,
+                               gmx_bool     bUseLossyCompression,
+                               int64_t      step,
+                               double       t,
+                               real         lambda,
+                               const rvec*  box,
+                               int          natoms,
+                               const rvec*  x,
+                               const rvec*  v,
+                               const rvec*  f)
+{
+    if (!of->tngLowPrecWriter)
+    {
+        gmx_fwrite_tng(
+                of->tng_low_prec, bUseLossyCompression, step, t, lambda, box, natoms, x, v, f);
+        return;
+    }
+
+    const auto copyVectors = [natoms](const rvec* source, std::vector<gmx::RVec>* destination) {
+        if (source)
+        {
+            const gmx::RVec* sourceRVec = reinterpret_cast<const gmx::RVec*>(source);
+            destination->assign(sourceRVec, sourceRVec + natoms);
+        }
+        else
+        {
+            destination->clear();
+        }
+    };
+    const bool writeOK = of->tngLowPrecWriter->write(
+            [&](gmx::TngFrame* frame) {
+                frame->useLossyCompression = bUseLossyCompression;
+                frame->step                = step;
+                frame->time                = t;
+                frame->lambda              = lambda;
+                frame->haveBox             = (box != nullptr);
+                if (box)
+                {
+                    copy_mat(box, frame->box);
+                }
+                frame->numAtoms = natoms;
+                copyVectors(x, &frame->x);
+                copyVectors(v, &frame->v);
+                copyVectors(f, &frame->f);
+            },
+            of->wcycle);
+    if (!writeOK)
+    {
+        tngWriteError();
+    }
+}
+
+//! Waits for all frames of the compressed TNG file to be written and stops its writer thread
+static void stop_tng_low_prec_writer(gmx_mdoutf_t of)
+{
+    if (of->tngLowPrecWriter)
+    {
+        const bool writeOK = of->tngLowPrecWriter->waitForCompletion(of->wcycle);
+        delete of->tngLowPrecWriter;
+        of->tngLowPrecWriter = nullptr;
+        if (!writeOK)
+        {
+            tngWriteError();
+        }
+    }
+}
+
+/*! \brief Copies the positions of the atoms in the compressed output group
+ *
+ * \param[in]  of           The output handler
+ * \param[in]  x            The global positions
+ * \param[out] xCompressed  Buffer for of->natoms_x_compressed positions
+ */
+static void copyCompressedOutputPositions(const gmx_mdoutf*              of,
+                                          gmx::ArrayRef<const gmx::RVec> x,
+                                          rvec*                          xCompressed)
+{
+    for (int i = 0, j = 0; i < of->natoms_global; i++)
+    {
+        if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+        {
+            copy_rvec(x[i], xCompressed[j++]);
+        }
+    }
 }
 
 void mdoutf_write_to_trajectory_files(FILE*                           fplog,
@@ -670,66 +1209,91 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                coordinate output) also write forces and velocities to it. */
             else if (of->tng_low_prec)
             {
-                gmx_fwrite_tng(of->tng_low_prec,
-                               FALSE,
-                               step,
-                               t,
-                               state_local->lambda[FreeEnergyPerturbationCouplingType::Fep],
-                               state_local->box,
-                               natoms,
-                               x,
-                               v,
-                               f);
+                write_tng_low_prec(of,
+                                   FALSE,
+                                   step,
+                                   t,
+                                   state_local->lambda[FreeEnergyPerturbationCouplingType::Fep],
+                                   state_local->box,
+                                   natoms,
+                                   x,
+                                   v,
+                                   f);
             }
         }
         if (mdof_flags & MDOF_X_COMPRESSED)
         {
-            rvec* xxtc = nullptr;
+            const bool writeAllAtoms = (of->natoms_x_compressed == of->natoms_global);
 
-            if (of->natoms_x_compressed == of->natoms_global)
+            if (of->xtcWriter)
             {
-                /* We are writing the positions of all of the atoms to
-                   the compressed output */
-                xxtc = state_global->x.rvec_array();
+                /* Copy the positions directly into the frame buffer of the writer */
+                if (!of->xtcWriter->write(
+                            [&](gmx::XtcFrame* frame) {
+                                frame->step = step;
+                                frame->time = t;
+                                copy_mat(state_local->box, frame->box);
+                                if (writeAllAtoms)
+                                {
+                                    frame->x.assign(
+                                            state_global->x.begin(),
+                                            state_global->x.begin() + of->natoms_x_compressed);
+                                }
+                                else
+                                {
+                                    frame->x.resize(of->natoms_x_compressed);
+                                    copyCompressedOutputPositions(
+                                            of, state_global->x, as_rvec_array(frame->x.data()));
+                                }
+                            },
+                            of->wcycle))
+                {
+                    xtcWriteError();
+                }
             }
             else
             {
-                /* We are writing the positions of only a subset of
-                   the atoms to the compressed output, so we have to
-                   make a copy of the subset of coordinates. */
-                int i, j;
-
-                snew(xxtc, of->natoms_x_compressed);
-                auto x = makeArrayRef(state_global->x);
-                for (i = 0, j = 0; (i < of->natoms_global); i++)
+                rvec* xxtc = nullptr;
+
+                if (writeAllAtoms)
                 {
-                    if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
-                    {
-                        copy_rvec(x[i], xxtc[j++]);
-                    }
+                    /* We are writing the positions of all of the atoms to
+                       the compressed output */
+                    xxtc = state_global->x.rvec_array();
+                }
+                else
+                {
+                    /* We are writing the positions of only a subset of
+                       the atoms to the compressed output, so we have to
+                       make a copy of the subset of coordinates. */
+                    snew(xxtc, of->natoms_x_compressed);
+                    copyCompressedOutputPositions(of, state_global->x, xxtc);
+                }
+                const gmx_off_t offset = (of->fp_xtc_index ? gmx_fio_ftell(of->fp_xtc) : 0);
+                if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc, of->x_compression_precision)
+                    == 0)
+                {
+                    xtcWriteError();
+                }
+                if (of->fp_xtc_index)
+                {
+                    write_xtc_frame_index_entry(of->fp_xtc_index,
+                                                { offset, step, static_cast<real>(t) });
+                }
+                write_tng_low_prec(of,
+                                   TRUE,
+                                   step,
+                                   t,
+                                   state_local->lambda[FreeEnergyPerturbationCouplingType::Fep],
+                                   state_local->box,
+                                   of->natoms_x_compressed,
+                                   xxtc,
+                                   nullptr,
+                                   nullptr);
+                if (!writeAllAtoms)
+                {
+                    sfree(xxtc);
                 }
-            }
-            if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc, of->x_compression_precision)
-                == 0)
-            {
-                gmx_fatal(FARGS,
-                          "XTC error. This indicates you are out of disk space, or a "
-                          "simulation with major instabilities resulting in coordinates "
-                          "that are NaN or too large to be represented in the XTC format.\n");
-            }
-            gmx_fwrite_tng(of->tng_low_prec,
-                           TRUE,
-                           step,
-                           t,
-                           state_local->lambda[FreeEnergyPerturbationCouplingType::Fep],
-                           state_local->box,
-                           of->natoms_x_compressed,
-                           xxtc,
-                           nullptr,
-                           nullptr);
-            if (of->natoms_x_compressed != of->natoms_global)
-            {
-                sfree(xxtc);
             }
         }
         if (mdof_flags & (MDOF_BOX | MDOF_LAMBDA) && !(mdof_flags & (MDOF_X | MDOF_V | MDOF_F)))
@@ -764,7 +1328,7 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                 {
                     lambda = state_local->lambda[FreeEnergyPerturbationCouplingType::Fep];
                 }
-                gmx_fwrite_tng(of->tng_low_prec, FALSE, step, t, lambda, box, natoms, nullptr, nullptr, nullptr);
+                write_tng_low_prec(of, FALSE, step, t, lambda, box, natoms, nullptr, nullptr, nullptr);
             }
         }
 
@@ -784,6 +1348,7 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
     if (of->tng || of->tng_low_prec)
     {
         wallcycle_start(of->wcycle, WallCycleCounter::Traj);
+        stop_tng_low_prec_writer(of);
         gmx_tng_close(&of->tng);
         gmx_tng_close(&of->tng_low_prec);
         wallcycle_stop(of->wcycle, WallCycleCounter::Traj);
@@ -792,10 +1357,30 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    /* The run has ended, so the waits for the output threads below are not timed */
+    if (of->checkpointFinalizer)
+    {
+        /* Finalizing the checkpoint accesses the output files */
+        of->checkpointFinalizer->waitForCompletion(nullptr);
+        delete of->checkpointFinalizer;
+    }
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
     }
+    if (of->xtcWriter)
+    {
+        const bool writeOK = of->xtcWriter->waitForCompletion(nullptr);
+        delete of->xtcWriter;
+        if (!writeOK)
+        {
+            xtcWriteError();
+        }
+    }
+    if (of->fp_xtc_index)
+    {
+        gmx_ffclose(of->fp_xtc_index);
+    }
     if (of->fp_xtc)
     {
         close_xtc(of->fp_xtc);
@@ -814,6 +1399,7 @@ void done_mdoutf(gmx_mdoutf_t of)
         sfree(of->f_global);
     }
 
+    stop_tng_low_prec_writer(of);
     gmx_tng_close(&of->tng);
     gmx_tng_close(&of->tng_low_prec);
 
@@ -135,13 +135,10 @@ int add_bind(t_bin* b, gmx::ArrayRef<const double> r)
 
 void sum_bin(t_bin* b, const t_commrec* cr)
 {
-    int i;
-
-    for (i = b->nreal; (i < b->maxreal); i++)
-    {
-        b->rbuf[i] = 0;
-    }
-    gmx_sumd(b->maxreal, b->rbuf, cr);
+    /* Only the filled part needs to be communicated, the buffer
+     * can be larger due to earlier calls with more entries.
+     */
+    gmx_sumd(b->nreal, b->rbuf, cr);
 }
 
 void extract_binr(t_bin* b, int index, int nr, real r[])
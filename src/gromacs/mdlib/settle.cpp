@@ -44,6 +44,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 
@@ -369,6 +370,28 @@ void settle_proj(const SettleData&    settled,
 }
 
 
+/*! \brief Computes the distance vector \p dx = \p x1 - \p x2 without PBC
+ *
+ * Overload for TypePbc=std::nullptr_t, which we use when no PBC
+ * treatment is required. This avoids the PBC correction cost, which
+ * is a significant part of the SETTLE flops.
+ */
+template<typename T>
+static inline void settleDx(std::nullptr_t /* pbc */, const T x1[], const T x2[], T dx[])
+{
+    for (int d = 0; d < DIM; d++)
+    {
+        dx[d] = x1[d] - x2[d];
+    }
+}
+
+//! Computes the distance vector \p dx = \p x1 - \p x2 with PBC
+template<typename T, typename TypePbc>
+static inline void settleDx(const TypePbc pbc, const T x1[], const T x2[], T dx[])
+{
+    pbc_dx_aiuc(pbc, x1, x2, dx);
+}
+
 /*! \brief The actual settle code, templated for real/SimdReal and for optimization */
 template<typename T, typename TypeBool, int packSize, typename TypePbc, bool bCorrectVelocity, bool bCalcVirial>
 static void settleTemplate(const SettleData&  settled,
@@ -452,14 +475,14 @@ static void settleTemplate(const SettleData&  settled,
         T dist21[DIM], dist31[DIM];
         T doh2[DIM], doh3[DIM];
 
-        pbc_dx_aiuc(pbc, x_hw2, x_ow1, dist21);
+        settleDx(pbc, x_hw2, x_ow1, dist21);
 
-        pbc_dx_aiuc(pbc, x_hw3, x_ow1, dist31);
+        settleDx(pbc, x_hw3, x_ow1, dist31);
 
-        pbc_dx_aiuc(pbc, xprime_hw2, xprime_ow1, doh2);
+        settleDx(pbc, xprime_hw2, xprime_ow1, doh2);
 
-        pbc_dx_aiuc(pbc, xprime_hw3, xprime_ow1, doh3);
-        /* 4 * 18 flops (would be 4 * 3 without PBC) */
+        settleDx(pbc, xprime_hw3, xprime_ow1, doh3);
+        /* 4 * 18 flops with PBC, 4 * 3 without */
 
         /* Note that we completely avoid computing the center of mass and
          * only use distances. This minimizes energy drift and also makes
@@ -768,32 +791,34 @@ void csettle(const SettleData&               settled,
 #if GMX_SIMD_HAVE_REAL
     if (settled.useSimd())
     {
-        /* Convert the pbc struct for SIMD */
-        alignas(GMX_SIMD_ALIGNMENT) real pbcSimd[9 * GMX_SIMD_REAL_WIDTH];
-        set_pbc_simd(pbc, pbcSimd);
+        if (pbc == nullptr)
+        {
+            settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, std::nullptr_t>(
+                    settled, nthread, thread, nullptr, xPtr, xprimePtr, invdt, vPtr, bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
+        }
+        else
+        {
+            /* Convert the pbc struct for SIMD */
+            alignas(GMX_SIMD_ALIGNMENT) real pbcSimd[9 * GMX_SIMD_REAL_WIDTH];
+            set_pbc_simd(pbc, pbcSimd);
 
-        settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, const real*>(
-                settled, nthread, thread, pbcSimd, xPtr, xprimePtr, invdt, vPtr, bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
+            settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, const real*>(
+                    settled, nthread, thread, pbcSimd, xPtr, xprimePtr, invdt, vPtr, bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
+        }
     }
     else
 #endif
     {
-        /* This construct is needed because pbc_dx_aiuc doesn't accept pbc=NULL */
-        t_pbc        pbcNo;
-        const t_pbc* pbcNonNull;
-
-        if (pbc != nullptr)
+        if (pbc == nullptr)
         {
-            pbcNonNull = pbc;
+            settleTemplateWrapper<real, bool, 1, std::nullptr_t>(
+                    settled, nthread, thread, nullptr, &xPtr[0], &xprimePtr[0], invdt, &vPtr[0], bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
         }
         else
         {
-            set_pbc(&pbcNo, PbcType::No, nullptr);
-            pbcNonNull = &pbcNo;
+            settleTemplateWrapper<real, bool, 1, const t_pbc*>(
+                    settled, nthread, thread, pbc, &xPtr[0], &xprimePtr[0], invdt, &vPtr[0], bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
         }
-
-        settleTemplateWrapper<real, bool, 1, const t_pbc*>(
-                settled, nthread, thread, pbcNonNull, &xPtr[0], &xprimePtr[0], invdt, &vPtr[0], bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
     }
 }
 
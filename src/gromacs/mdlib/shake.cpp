@@ -49,6 +49,7 @@
 #include <algorithm>
 #include <array>
 #include <filesystem>
+#include <limits>
 #include <string>
 
 #include "gromacs/gmxlib/nrnb.h"
@@ -64,6 +65,7 @@
 #include "gromacs/topology/invblock.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/listoflists.h"
@@ -77,6 +79,9 @@ typedef struct
     int blocknr;
 } t_sortblock;
 
+//! The maximum number of SHAKE iterations
+static constexpr int c_shakeMaxIterations = 1000;
+
 //! Compares sort blocks.
 static int pcomp(const void* p1, const void* p2)
 {
@@ -129,6 +134,64 @@ static void resizeLagrangianData(shakedata* shaked, int ncons)
     shaked->scaled_lagrange_multiplier.resize(ncons);
 }
 
+/*! \brief Distributes the SHAKE blocks over threads
+ *
+ * Blocks can share atoms, in particular with domain decomposition,
+ * so we only split between two blocks when all atoms of the blocks
+ * before the split have lower indices than all atoms after the split.
+ * Within those constraints we aim for equal numbers of constraints
+ * per thread. Each thread processes its blocks in serial order, which
+ * keeps the results independent of the number of threads.
+ */
+static void setThreadBlockRanges(shakedata* shaked, ArrayRef<const int> iatoms)
+{
+    const int numBlocks  = shaked->numShakeBlocks();
+    const int numThreads = std::max(shaked->numThreads, 1);
+
+    shaked->threadBlockStart.resize(numThreads + 1);
+    shaked->threadData.resize(numThreads);
+
+    shaked->threadBlockStart[0] = 0;
+    if (numThreads == 1 || numBlocks <= 1)
+    {
+        std::fill(shaked->threadBlockStart.begin() + 1, shaked->threadBlockStart.end(), numBlocks);
+        return;
+    }
+
+    // The minimum atom index of each block and all blocks after it
+    std::vector<int> minAtomFromBlock(numBlocks + 1, std::numeric_limits<int>::max());
+    for (int b = numBlocks - 1; b >= 0; b--)
+    {
+        int minAtom = minAtomFromBlock[b + 1];
+        for (int i = shaked->sblock[b]; i < shaked->sblock[b + 1]; i += 3)
+        {
+            minAtom = std::min(minAtom, std::min(iatoms[i + 1], iatoms[i + 2]));
+        }
+        minAtomFromBlock[b] = minAtom;
+    }
+
+    const int numConstraints = shaked->sblock[numBlocks] / 3;
+    int       thread         = 1;
+    int       maxAtom        = -1;
+    for (int b = 0; b < numBlocks && thread < numThreads; b++)
+    {
+        for (int i = shaked->sblock[b]; i < shaked->sblock[b + 1]; i += 3)
+        {
+            maxAtom = std::max(maxAtom, std::max(iatoms[i + 1], iatoms[i + 2]));
+        }
+        const int numConstraintsBefore = shaked->sblock[b + 1] / 3;
+        if (numConstraintsBefore * numThreads >= thread * numConstraints
+            && maxAtom < minAtomFromBlock[b + 1])
+        {
+            shaked->threadBlockStart[thread++] = b + 1;
+        }
+    }
+    for (; thread <= numThreads; thread++)
+    {
+        shaked->threadBlockStart[thread] = numBlocks;
+    }
+}
+
 void make_shake_sblock_serial(shakedata* shaked, InteractionDefinitions* idef, const int numAtoms)
 {
     int bstart, bnr;
@@ -204,6 +267,7 @@ void make_shake_sblock_serial(shakedata* shaked, InteractionDefinitions* idef, c
     shaked->sblock.push_back(3 * ncons);
 
     resizeLagrangianData(shaked, ncons);
+    setThreadBlockRanges(shaked, idef->il[F_CONSTR].iatoms);
 }
 
 void make_shake_sblock_dd(shakedata* shaked, const InteractionList& ilcon)
@@ -228,6 +292,7 @@ void make_shake_sblock_dd(shakedata* shaked, const InteractionList& ilcon)
     }
     shaked->sblock.push_back(3 * ncons);
     resizeLagrangianData(shaked, ncons);
+    setThreadBlockRanges(shaked, ilcon.iatoms);
 }
 
 /*! \brief Inner kernel for SHAKE constraints
@@ -428,9 +493,12 @@ static void crattle(const int            iatom[],
     *nerror = error;
 }
 
-//! Applies SHAKE
-static int vec_shakef(FILE*                     fplog,
-                      shakedata*                shaked,
+/*! \brief Applies SHAKE to a block of constraints
+ *
+ * Returns 0 on failure and then stores the failure in \p shaked, so it can be
+ * reported by the calling thread after all threads have finished.
+ */
+static int vec_shakef(ShakeThreadData*          shaked,
                       ArrayRef<const real>      invmass,
                       int                       ncon,
                       ArrayRef<const t_iparams> ip,
@@ -449,7 +517,7 @@ static int vec_shakef(FILE*                     fplog,
                       tensor                    vir_r_m_dr,
                       ConstraintVariable        econq)
 {
-    int  maxnit = 1000;
+    int  maxnit = c_shakeMaxIterations;
     int  nit    = 0, ll, i, j, d, d2, type;
     real L1;
     int  error = 0;
@@ -534,31 +602,13 @@ static int vec_shakef(FILE*                     fplog,
 
     if (nit >= maxnit)
     {
-        if (fplog)
-        {
-            fprintf(fplog, "Shake did not converge in %d steps\n", maxnit);
-        }
-        fprintf(stderr, "Shake did not converge in %d steps\n", maxnit);
-        nit = 0;
+        shaked->failedConstraint = -1;
+        nit                      = 0;
     }
     else if (error != 0)
     {
-        if (fplog)
-        {
-            fprintf(fplog,
-                    "Inner product between old and new vector <= 0.0!\n"
-                    "constraint #%d atoms %d and %d\n",
-                    error - 1,
-                    iatom[3 * (error - 1) + 1] + 1,
-                    iatom[3 * (error - 1) + 2] + 1);
-        }
-        fprintf(stderr,
-                "Inner product between old and new vector <= 0.0!\n"
-                "constraint #%d atoms %d and %d\n",
-                error - 1,
-                iatom[3 * (error - 1) + 1] + 1,
-                iatom[3 * (error - 1) + 2] + 1);
-        nit = 0;
+        shaked->failedConstraint = error - 1;
+        nit                      = 0;
     }
 
     /* Constraint virial and correct the Lagrange multipliers for the length */
@@ -618,6 +668,43 @@ static int vec_shakef(FILE*                     fplog,
     return nit;
 }
 
+/*! \brief Reports a SHAKE failure to \p fplog and stderr
+ *
+ * \param[in] fplog             The log file, can be nullptr
+ * \param[in] iatom             The constraint atoms of the failed block
+ * \param[in] failedConstraint  The constraint with a non-positive inner product,
+ *                              -1 when SHAKE did not converge
+ */
+static void reportShakeFailure(FILE* fplog, const int* iatom, int failedConstraint)
+{
+    if (failedConstraint < 0)
+    {
+        if (fplog)
+        {
+            fprintf(fplog, "Shake did not converge in %d steps\n", c_shakeMaxIterations);
+        }
+        fprintf(stderr, "Shake did not converge in %d steps\n", c_shakeMaxIterations);
+    }
+    else
+    {
+        if (fplog)
+        {
+            fprintf(fplog,
+                    "Inner product between old and new vector <= 0.0!\n"
+                    "constraint #%d atoms %d and %d\n",
+                    failedConstraint,
+                    iatom[3 * failedConstraint + 1] + 1,
+                    iatom[3 * failedConstraint + 2] + 1);
+        }
+        fprintf(stderr,
+                "Inner product between old and new vector <= 0.0!\n"
+                "constraint #%d atoms %d and %d\n",
+                failedConstraint,
+                iatom[3 * failedConstraint + 1] + 1,
+                iatom[3 * failedConstraint + 2] + 1);
+    }
+}
+
 //! Check that constraints are satisfied.
 static void check_cons(FILE*                     log,
                        int                       nc,
@@ -707,7 +794,7 @@ static bool bshakef(FILE*                         log,
                     ConstraintVariable            econq)
 {
     real dt_2, dvdl;
-    int  i, n0, ncon, blen, type, ll;
+    int  ncon, type, ll;
     int  tnit = 0, trij = 0;
 
     ncon = idef.il[F_CONSTR].size() / 3;
@@ -717,50 +804,89 @@ static bool bshakef(FILE*                         log,
         shaked->scaled_lagrange_multiplier[ll] = 0;
     }
 
-    // TODO Rewrite this block so that it is obvious that i, iatoms
-    // and lam are all iteration variables. Is this easier if the
-    // sblock data structure is organized differently?
-    const int*     iatoms = &(idef.il[F_CONSTR].iatoms[shaked->sblock[0]]);
-    ArrayRef<real> lam    = shaked->scaled_lagrange_multiplier;
-    for (i = 0; (i < shaked->numShakeBlocks());)
-    {
-        blen = (shaked->sblock[i + 1] - shaked->sblock[i]);
-        blen /= 3;
-        n0 = vec_shakef(log,
-                        shaked,
-                        invmass,
-                        blen,
-                        idef.iparams,
-                        iatoms,
-                        ir.shake_tol,
-                        x_s,
-                        prime,
-                        pbc,
-                        shaked->omega,
-                        ir.efep != FreeEnergyPerturbationType::No,
-                        lambda,
-                        lam,
-                        invdt,
-                        v,
-                        bCalcVir,
-                        vir_r_m_dr,
-                        econq);
-
-        if (n0 == 0)
+    ArrayRef<const int> iatomsAll = idef.il[F_CONSTR].iatoms;
+    ArrayRef<real>      lamAll    = shaked->scaled_lagrange_multiplier;
+
+    const int gmx_unused numThreads = gmx::ssize(shaked->threadData);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int th = 0; th < numThreads; th++)
+    {
+        try
         {
-            if (bDumpOnError && log)
+            ShakeThreadData& threadData = shaked->threadData[th];
+
+            threadData.numIterations  = 0;
+            threadData.numConstraints = 0;
+            threadData.failedBlock    = -1;
+            clear_mat(threadData.virial);
+
+            for (int b = shaked->threadBlockStart[th]; b < shaked->threadBlockStart[th + 1]; b++)
             {
+                const int  blockStart = shaked->sblock[b] / 3;
+                const int  blen       = shaked->sblock[b + 1] / 3 - blockStart;
+                const int* iatoms     = iatomsAll.data() + shaked->sblock[b];
+
+                const int n0 = vec_shakef(&threadData,
+                                          invmass,
+                                          blen,
+                                          idef.iparams,
+                                          iatoms,
+                                          ir.shake_tol,
+                                          x_s,
+                                          prime,
+                                          pbc,
+                                          shaked->omega,
+                                          ir.efep != FreeEnergyPerturbationType::No,
+                                          lambda,
+                                          lamAll.subArray(blockStart, blen),
+                                          invdt,
+                                          v,
+                                          bCalcVir,
+                                          threadData.virial,
+                                          econq);
+
+                if (n0 == 0)
                 {
-                    check_cons(log, blen, x_s, prime, v, pbc, idef.iparams, iatoms, invmass, econq);
+                    threadData.failedBlock = b;
+                    break;
                 }
+                threadData.numIterations += n0 * blen;
+                threadData.numConstraints += blen;
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    /* Reduce in thread order, so the result is reproducible */
+    for (const ShakeThreadData& threadData : shaked->threadData)
+    {
+        if (threadData.failedBlock >= 0)
+        {
+            /* Only report the first failure, as the serial code would */
+            const int b = threadData.failedBlock;
+            reportShakeFailure(
+                    log, iatomsAll.data() + shaked->sblock[b], threadData.failedConstraint);
+            if (bDumpOnError && log)
+            {
+                check_cons(log,
+                           (shaked->sblock[b + 1] - shaked->sblock[b]) / 3,
+                           x_s,
+                           prime,
+                           v,
+                           pbc,
+                           idef.iparams,
+                           iatomsAll.data() + shaked->sblock[b],
+                           invmass,
+                           econq);
             }
             return FALSE;
         }
-        tnit += n0 * blen;
-        trij += blen;
-        iatoms += 3 * blen; /* Increment pointer! */
-        lam = lam.subArray(blen, lam.ssize() - blen);
-        i++;
+        tnit += threadData.numIterations;
+        trij += threadData.numConstraints;
+        if (bCalcVir)
+        {
+            m_add(vir_r_m_dr, threadData.virial, vir_r_m_dr);
+        }
     }
     /* only for position part? */
     if (econq == ConstraintVariable::Positions)
@@ -67,13 +67,10 @@ class ArrayRef;
 enum class ConstraintVariable : int;
 
 /*! \libinternal
- * \brief Working data for the SHAKE algorithm
+ * \brief Thread-local working data for the SHAKE algorithm
  */
-struct shakedata
+struct ShakeThreadData
 {
-    //! Returns the number of SHAKE blocks */
-    int numShakeBlocks() const { return sblock.size() - 1; }
-
     //! The reference constraint vectors
     std::vector<RVec> rij;
     //! The reduced mass of the two atoms in each constraint times 0.5
@@ -82,6 +79,37 @@ struct shakedata
     std::vector<real> distance_squared_tolerance;
     //! The reference constraint distances squared
     std::vector<real> constraint_distance_squared;
+    //! The constraint virial contribution of the blocks of this thread
+    tensor virial = { { 0 } };
+    //! The number of iterations times constraints, for flop counting
+    int numIterations = 0;
+    //! The number of constraints handled by this thread
+    int numConstraints = 0;
+    //! The index of the first block that failed to converge, -1 when all converged
+    int failedBlock = -1;
+    //! The constraint in the failed block with a non-positive inner product, -1 for no convergence
+    int failedConstraint = -1;
+};
+
+/*! \libinternal
+ * \brief Working data for the SHAKE algorithm
+ *
+ * The blocks are distributed over threads in contiguous ranges
+ * that do not share atoms. Within each range the blocks are
+ * processed in the same order as in serial, so the constrained
+ * coordinates do not depend on the number of threads.
+ */
+struct shakedata
+{
+    //! Returns the number of SHAKE blocks */
+    int numShakeBlocks() const { return sblock.size() - 1; }
+
+    //! The number of OpenMP threads to use, set before making the blocks
+    int numThreads = 1;
+    //! Thread t handles blocks threadBlockStart[t] to threadBlockStart[t+1]
+    std::vector<int> threadBlockStart = { 0, 0 };
+    //! Working data for each thread
+    std::vector<ShakeThreadData> threadData = std::vector<ShakeThreadData>(1);
     /* SOR stuff */
     //! SOR delta
     real delta = 0.1;
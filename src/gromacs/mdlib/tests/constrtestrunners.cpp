@@ -91,6 +91,7 @@ namespace test
 void ShakeConstraintsRunner::applyConstraints(ConstraintsTestData* testData, t_pbc /* pbc */)
 {
     shakedata shaked;
+    shaked.numThreads = numThreads_;
     make_shake_sblock_serial(&shaked, testData->idef_.get(), testData->numAtoms_);
     bool success = constrain_shake(nullptr,
                                    &shaked,
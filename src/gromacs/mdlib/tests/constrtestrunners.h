@@ -95,8 +95,11 @@ public:
 class ShakeConstraintsRunner : public IConstraintsTestRunner
 {
 public:
-    //! Default constructor.
-    ShakeConstraintsRunner() {}
+    /*! \brief Constructor.
+     *
+     * \param[in] numThreads  The number of OpenMP threads to distribute the SHAKE blocks over.
+     */
+    ShakeConstraintsRunner(int numThreads = 1) : numThreads_(numThreads) {}
     /*! \brief Apply SHAKE constraints to the test data.
      *
      * \param[in] testData             Test data structure.
@@ -107,7 +110,15 @@ public:
      *
      * \return "SHAKE" string;
      */
-    std::string name() override { return "SHAKE on CPU"; }
+    std::string name() override
+    {
+        return numThreads_ == 1 ? "SHAKE on CPU"
+                                : "SHAKE on CPU with " + std::to_string(numThreads_) + " threads";
+    }
+
+private:
+    //! The number of OpenMP threads
+    int numThreads_;
 };
 
 // Runner for the CPU implementation of LINCS constraints algorithm.
@@ -81,10 +81,11 @@ void SettleHostTestRunner::applySettle(SettleTestData*    testData,
     bool errorOccured;
     int  numThreads  = 1;
     int  threadIndex = 0;
+    // Without PBC the constraints code passes nullptr, so exercise that code path
     csettle(settled,
             numThreads,
             threadIndex,
-            &pbc,
+            pbc.pbcType == PbcType::No ? nullptr : &pbc,
             testData->x_.arrayRefWithPadding(),
             testData->xPrime_.arrayRefWithPadding(),
             testData->reciprocalTimeStep_,
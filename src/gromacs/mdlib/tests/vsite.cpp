@@ -0,0 +1,312 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the construction of virtual sites.
+ *
+ * Without PBC, F_VSITE3 sites are constructed with SIMD when available,
+ * with PBC the plain-C code is used. These tests compare both against
+ * a simple reference and against each other.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/vsite.h"
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/forcefieldparameters.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Three constructing atoms followed by the virtual site
+constexpr int c_numAtomsPerMolecule = 4;
+
+//! The number of elements per F_VSITE3 entry in the interaction list: type and four atoms
+constexpr int c_ilistEntrySize = 1 + c_numAtomsPerMolecule;
+
+//! The edge of the cubic box used for the PBC tests
+constexpr real c_boxSize = 3.0;
+
+/*! \brief The largest number of vsites we test with
+ *
+ * This covers several full packs plus all remainder counts
+ * for any SIMD width up to 16.
+ */
+constexpr int c_maxNumVsites = 35;
+
+//! Returns force-field parameters with two F_VSITE3 types
+gmx_ffparams_t vsite3Parameters()
+{
+    gmx_ffparams_t ffparams;
+
+    t_iparams tip4p = {};
+    tip4p.vsite.a   = 0.128;
+    tip4p.vsite.b   = 0.128;
+    t_iparams asymmetric = {};
+    asymmetric.vsite.a   = 0.3;
+    asymmetric.vsite.b   = -0.2;
+
+    ffparams.functype = { F_VSITE3, F_VSITE3 };
+    ffparams.iparams  = { tip4p, asymmetric };
+
+    return ffparams;
+}
+
+/*! \brief Returns a molecule type with \p numVsites times three atoms and a F_VSITE3 site
+ *
+ * The two parameter types are used alternately.
+ */
+gmx_moltype_t vsite3Molecules(int numVsites)
+{
+    gmx_moltype_t moltype = {};
+
+    moltype.atoms.nr = numVsites * c_numAtomsPerMolecule;
+    for (int m = 0; m < numVsites; m++)
+    {
+        const int a0 = m * c_numAtomsPerMolecule;
+        moltype.ilist[F_VSITE3].push_back(
+                m % 2, std::array<int, c_numAtomsPerMolecule>{ a0 + 3, a0, a0 + 1, a0 + 2 });
+    }
+
+    return moltype;
+}
+
+//! Fills \p mtop with a single molecule block of vsite3Molecules()
+void fillTopology(gmx_mtop_t* mtop, int numVsites)
+{
+    mtop->ffparams = vsite3Parameters();
+    mtop->moltype.push_back(vsite3Molecules(numVsites));
+    mtop->molblock.resize(1);
+    mtop->molblock[0].type = 0;
+    mtop->molblock[0].nmol = 1;
+    mtop->natoms           = mtop->moltype[0].atoms.nr;
+}
+
+/*! \brief Returns coordinates for \p numVsites molecules, all inside the box
+ *
+ * The molecules are placed along a diagonal through the box,
+ * the vsite positions are set to a dummy value.
+ */
+std::vector<RVec> moleculeCoordinates(int numVsites)
+{
+    std::vector<RVec> x(numVsites * c_numAtomsPerMolecule);
+    for (int m = 0; m < numVsites; m++)
+    {
+        const RVec base(
+                0.2_real + 0.07_real * m, 0.3_real + 0.05_real * m, 0.4_real + 0.03_real * m);
+        const int  a0 = m * c_numAtomsPerMolecule;
+        x[a0]         = base;
+        x[a0 + 1]     = base + RVec(0.1_real, 0.05_real, -0.02_real);
+        x[a0 + 2]     = base + RVec(-0.03_real, 0.09_real, 0.04_real);
+        x[a0 + 3]     = { -1.0_real, -1.0_real, -1.0_real };
+    }
+    return x;
+}
+
+//! Returns the reference F_VSITE3 position for the given constructing atoms
+RVec referenceVsite3(const RVec& xi, const RVec& xj, const RVec& xk, const t_iparams& iparams)
+{
+    return xi + iparams.vsite.a * (xj - xi) + iparams.vsite.b * (xk - xi);
+}
+
+//! Returns the tolerance for comparing positions within the box
+FloatingPointTolerance positionTolerance()
+{
+    return absoluteTolerance(10 * c_boxSize * GMX_REAL_EPS);
+}
+
+//! Checks that \p x and \p xRef match for all atoms
+void checkPositions(ArrayRef<const RVec> xRef, ArrayRef<const RVec> x, int numVsites)
+{
+    ASSERT_EQ(xRef.size(), x.size());
+    for (Index a = 0; a < x.ssize(); a++)
+    {
+        SCOPED_TRACE(formatString("Testing atom %td with %d vsites", a, numVsites));
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(xRef[a][d], x[a][d], positionTolerance());
+        }
+    }
+}
+
+TEST(VsiteConstructionTest, Vsite3MatchesReferenceWithoutPbc)
+{
+    const gmx_ffparams_t ffparams = vsite3Parameters();
+
+    for (int numVsites = 1; numVsites <= c_maxNumVsites; numVsites++)
+    {
+        const gmx_moltype_t moltype = vsite3Molecules(numVsites);
+        std::vector<RVec>   x       = moleculeCoordinates(numVsites);
+
+        std::vector<RVec> xRef = x;
+        for (int m = 0; m < numVsites; m++)
+        {
+            const int a0 = m * c_numAtomsPerMolecule;
+            xRef[a0 + 3] =
+                    referenceVsite3(xRef[a0], xRef[a0 + 1], xRef[a0 + 2], ffparams.iparams[m % 2]);
+        }
+
+        constructVirtualSites(x, ffparams.iparams, moltype.ilist);
+
+        checkPositions(xRef, x, numVsites);
+    }
+}
+
+TEST(VsiteConstructionTest, Vsite3HandlesVsitesConstructedFromVsites)
+{
+    const gmx_ffparams_t ffparams = vsite3Parameters();
+
+    for (int numVsites = 2; numVsites <= c_maxNumVsites; numVsites++)
+    {
+        gmx_moltype_t     moltype = vsite3Molecules(numVsites);
+        std::vector<RVec> x       = moleculeCoordinates(numVsites);
+
+        /* Construct the second vsite from the first vsite, so the second
+         * vsite depends on another vsite in the same SIMD pack.
+         */
+        moltype.ilist[F_VSITE3].iatoms[c_ilistEntrySize + 2] = 3;
+
+        std::vector<RVec> xRef = x;
+        for (int m = 0; m < numVsites; m++)
+        {
+            const int a0 = m * c_numAtomsPerMolecule;
+            const int ai = (m == 1 ? 3 : a0);
+            xRef[a0 + 3] =
+                    referenceVsite3(xRef[ai], xRef[a0 + 1], xRef[a0 + 2], ffparams.iparams[m % 2]);
+        }
+
+        constructVirtualSites(x, ffparams.iparams, moltype.ilist);
+
+        checkPositions(xRef, x, numVsites);
+    }
+}
+
+TEST(VsiteConstructionTest, Vsite3MatchesBetweenSimdAndPbcCode)
+{
+    gmx_omp_nthreads_set(ModuleMultiThread::VirtualSite, 1);
+
+    matrix box = { { 0 } };
+    box[XX][XX] = c_boxSize;
+    box[YY][YY] = c_boxSize;
+    box[ZZ][ZZ] = c_boxSize;
+
+    for (int numVsites = 1; numVsites <= c_maxNumVsites; numVsites++)
+    {
+        gmx_mtop_t mtop;
+        fillTopology(&mtop, numVsites);
+
+        /* With PBC and without update groups, all vsites use the plain-C code */
+        VirtualSitesHandler vsitePbc(mtop, nullptr, PbcType::Xyz, {});
+        vsitePbc.setVirtualSites(mtop.moltype[0].ilist, mtop.natoms, mtop.natoms, {});
+
+        std::vector<RVec> xSimd = moleculeCoordinates(numVsites);
+        std::vector<RVec> xPbc  = xSimd;
+        /* The PBC code keeps the vsite in the periodic image it was in */
+        for (int m = 0; m < numVsites; m++)
+        {
+            xPbc[m * c_numAtomsPerMolecule + 3] = xPbc[m * c_numAtomsPerMolecule];
+        }
+
+        constructVirtualSites(xSimd, mtop.ffparams.iparams, mtop.moltype[0].ilist);
+        vsitePbc.construct(xPbc, {}, box, VSiteOperation::Positions);
+
+        checkPositions(xPbc, xSimd, numVsites);
+    }
+}
+
+TEST(VsiteConstructionTest, Vsite3MatchesReferenceOverPeriodicBoundaries)
+{
+    gmx_omp_nthreads_set(ModuleMultiThread::VirtualSite, 1);
+
+    matrix box = { { 0 } };
+    box[XX][XX] = c_boxSize;
+    box[YY][YY] = c_boxSize;
+    box[ZZ][ZZ] = c_boxSize;
+
+    const int numVsites = c_maxNumVsites;
+
+    gmx_mtop_t mtop;
+    fillTopology(&mtop, numVsites);
+
+    VirtualSitesHandler vsite(mtop, nullptr, PbcType::Xyz, {});
+    vsite.setVirtualSites(mtop.moltype[0].ilist, mtop.natoms, mtop.natoms, {});
+
+    /* Shift the first atom of each molecule by a box vector, so each
+     * molecule is split over the periodic boundaries.
+     */
+    std::vector<RVec> x    = moleculeCoordinates(numVsites);
+    std::vector<RVec> xRef = x;
+    for (int m = 0; m < numVsites; m++)
+    {
+        const int a0 = m * c_numAtomsPerMolecule;
+        const int d  = m % DIM;
+        x[a0][d] += (m % 2 == 0 ? c_boxSize : -c_boxSize);
+
+        xRef[a0 + 3] = referenceVsite3(
+                xRef[a0], xRef[a0 + 1], xRef[a0 + 2], mtop.ffparams.iparams[m % 2]);
+        xRef[a0]     = x[a0];
+        /* The vsite should end up in the image closest to its old position */
+        x[a0 + 3] = xRef[a0 + 3] + RVec(0.01_real, -0.01_real, 0.01_real);
+    }
+
+    vsite.construct(x, {}, box, VSiteOperation::Positions);
+
+    checkPositions(xRef, x, numVsites);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
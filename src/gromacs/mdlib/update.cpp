@@ -1679,6 +1679,8 @@ void Update::Impl::finish_update(const t_inputrec&                   inputRecord
     auto xp = makeConstArrayRef(xp_).subArray(0, homenr);
     auto x  = makeArrayRef(state->x).subArray(0, homenr);
 
+    int gmx_unused nth = gmx_omp_nthreads_get(ModuleMultiThread::Update);
+
     if (havePartiallyFrozenAtoms && haveConstraints)
     {
         /* We have atoms that are frozen along some, but not all dimensions,
@@ -1687,8 +1689,10 @@ void Update::Impl::finish_update(const t_inputrec&                   inputRecord
          */
         const ivec* nFreeze = inputRecord.opts.nFreeze;
 
+#pragma omp parallel for num_threads(nth) schedule(static)
         for (int i = 0; i < homenr; i++)
         {
+            // Trivial statements, do not throw
             const int g = cFREEZE[i];
 
             for (int d = 0; d < DIM; d++)
@@ -1705,7 +1709,6 @@ void Update::Impl::finish_update(const t_inputrec&                   inputRecord
         /* We have no frozen atoms or fully frozen atoms which have not
          * been moved by the update, so we can simply copy all coordinates.
          */
-        int gmx_unused nth = gmx_omp_nthreads_get(ModuleMultiThread::Update);
 #pragma omp parallel for num_threads(nth) schedule(static)
         for (int i = 0; i < homenr; i++)
         {
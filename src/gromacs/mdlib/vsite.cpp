@@ -42,6 +42,7 @@
 
 #include "vsite.h"
 
+#include <cstdint>
 #include <cstdio>
 
 #include <algorithm>
@@ -60,6 +61,7 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/simd/simd.h"
 #include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/block.h"
 #include "gromacs/topology/forcefieldparameters.h"
@@ -140,6 +142,8 @@ struct InterdependentTask
 {
     //! The interaction lists, only vsite entries are used
     InteractionLists ilist;
+    //! The number of F_VSITE3 entries in ilist.iatoms that can be constructed with SIMD
+    int numVsite3SimdIatoms = 0;
     //! Thread/task-local force buffer
     std::vector<RVec> force;
     //! The atom indices of the vsites of our task
@@ -166,6 +170,8 @@ struct VsiteThread
     int rangeEnd;
     //! The interaction lists, only vsite entries are used
     std::array<InteractionList, F_NRE> ilist;
+    //! The number of F_VSITE3 entries in ilist.iatoms that can be constructed with SIMD
+    int numVsite3SimdIatoms = 0;
     //! Local fshift accumulation buffer
     std::array<RVec, c_numShiftVectors> fshift;
     //! Local virial dx*df accumulation buffer
@@ -287,6 +293,8 @@ private:
     const ArrayRef<const t_iparams> iparams_;
     //! The interaction lists
     ArrayRef<const InteractionList> ilists_;
+    //! The number of F_VSITE3 entries in ilists_ that can use SIMD, only used without threading
+    int numVsite3SimdIatoms_ = 0;
     //! Information for handling vsite threading
     ThreadingInfo threadingInfo_;
 };
@@ -900,6 +908,123 @@ static PbcMode getPbcMode(const t_pbc* pbcPtr)
     }
 }
 
+/*! \brief Returns the number of leading F_VSITE3 elements of \p ilist.iatoms that can use SIMD
+ *
+ * The vsites are processed in packs of the SIMD width, starting at
+ * the beginning of the list. Counting stops at the first pack that can
+ * not be handled with SIMD. This is the case when a vsite in a pack is
+ * constructed from another vsite in the same pack, or when a gather
+ * could read beyond the end of the coordinate buffer.
+ *
+ * This check is quadratic in the SIMD width, so it should be done once
+ * after the interaction lists change, not at every construction.
+ *
+ * \param[in] ilist     The F_VSITE3 interaction list
+ * \param[in] numAtoms  The number of atoms in the coordinate buffer used for construction
+ */
+static int countVsite3SimdIatoms(const InteractionList& ilist, const int numAtoms)
+{
+#if GMX_SIMD_HAVE_REAL
+    constexpr int c_simdWidth = GMX_SIMD_REAL_WIDTH;
+    const int     c_inc       = 1 + NRAL(F_VSITE3);
+
+    const int numVsites = ilist.size() / c_inc;
+    /* The gathers load full SIMD widths starting at each atom. So any
+     * pack with a constructing atom among the last few atoms, usually
+     * only the last pack, is left to the plain-C code.
+     */
+    const int atomEnd = numAtoms - divideRoundUp(c_simdWidth, DIM);
+
+    int v = 0;
+    for (; v + c_simdWidth <= numVsites; v += c_simdWidth)
+    {
+        const t_iatom* ia = ilist.iatoms.data() + v * c_inc;
+
+        bool canUseSimd = true;
+        for (int s = 0; s < c_simdWidth; s++)
+        {
+            for (int atom = 2; atom < c_inc; atom++)
+            {
+                const int constructingAtom = ia[s * c_inc + atom];
+                canUseSimd                 = canUseSimd && constructingAtom < atomEnd;
+                for (int t = 0; t < c_simdWidth; t++)
+                {
+                    canUseSimd = canUseSimd && constructingAtom != ia[t * c_inc + 1];
+                }
+            }
+        }
+        if (!canUseSimd)
+        {
+            break;
+        }
+    }
+
+    return v * c_inc;
+#else
+    GMX_UNUSED_VALUE(ilist);
+    GMX_UNUSED_VALUE(numAtoms);
+
+    return 0;
+#endif
+}
+
+#if GMX_SIMD_HAVE_REAL
+/*! \brief Constructs the positions of F_VSITE3 virtual sites without PBC using SIMD
+ *
+ * Processes the first \p numSimdIatoms elements of \p ilist.iatoms, which
+ * should be determined by countVsite3SimdIatoms(). The remaining vsites should
+ * be constructed with the plain-C code.
+ */
+static void constructVsite3Simd(ArrayRef<RVec>            x,
+                                ArrayRef<const t_iparams> ip,
+                                const InteractionList&    ilist,
+                                const int                 numSimdIatoms)
+{
+    constexpr int c_simdWidth = GMX_SIMD_REAL_WIDTH;
+    const int     c_inc       = 1 + NRAL(F_VSITE3);
+
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t av[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         a[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         b[c_simdWidth];
+
+    real* xPtr = x.data()->as_vec();
+
+    for (int i = 0; i < numSimdIatoms; i += c_simdWidth * c_inc)
+    {
+        const t_iatom* ia = ilist.iatoms.data() + i;
+
+        for (int s = 0; s < c_simdWidth; s++)
+        {
+            av[s] = ia[s * c_inc + 1];
+            ai[s] = ia[s * c_inc + 2];
+            aj[s] = ia[s * c_inc + 3];
+            ak[s] = ia[s * c_inc + 4];
+            a[s]  = ip[ia[s * c_inc]].vsite.a;
+            b[s]  = ip[ia[s * c_inc]].vsite.b;
+        }
+
+        SimdReal xi[DIM], xj[DIM], xk[DIM];
+        gatherLoadUTranspose<DIM>(xPtr, ai, &xi[XX], &xi[YY], &xi[ZZ]);
+        gatherLoadUTranspose<DIM>(xPtr, aj, &xj[XX], &xj[YY], &xj[ZZ]);
+        gatherLoadUTranspose<DIM>(xPtr, ak, &xk[XX], &xk[YY], &xk[ZZ]);
+
+        const SimdReal aS = load<SimdReal>(a);
+        const SimdReal bS = load<SimdReal>(b);
+        const SimdReal cS = SimdReal(1.0_real) - aS - bS;
+
+        SimdReal xv[DIM];
+        for (int d = 0; d < DIM; d++)
+        {
+            xv[d] = fma(bS, xk[d], fma(aS, xj[d], cS * xi[d]));
+        }
+        transposeScatterStoreU<DIM>(xPtr, av, xv[XX], xv[YY], xv[ZZ]);
+    }
+}
+#endif // GMX_SIMD_HAVE_REAL
+
 /*! \brief Executes the vsite construction task for a single thread
  *
  * \tparam        calculatePosition  Whether we are calculating positions
@@ -908,6 +1033,8 @@ static PbcMode getPbcMode(const t_pbc* pbcPtr)
  * \param[in,out] v   Velocities are generated for virtual sites if calculateVelocity is true
  * \param[in]     ip  Interaction parameters for all interaction, only vsite parameters are used
  * \param[in]     ilist  The interaction lists, only vsites are usesd
+ * \param[in]     numVsite3SimdIatoms  The number of F_VSITE3 iatoms that can use SIMD,
+ *                                     see countVsite3SimdIatoms()
  * \param[in]     pbc_null  PBC struct, used for PBC distance calculations when !=nullptr
  */
 template<VSiteCalculatePosition calculatePosition, VSiteCalculateVelocity calculateVelocity>
@@ -915,6 +1042,7 @@ static void construct_vsites_thread(ArrayRef<RVec>                  x,
                                     ArrayRef<RVec>                  v,
                                     ArrayRef<const t_iparams>       ip,
                                     ArrayRef<const InteractionList> ilist,
+                                    const int                       numVsite3SimdIatoms,
                                     const t_pbc*                    pbc_null)
 {
     if (calculateVelocity == VSiteCalculateVelocity::Yes)
@@ -953,9 +1081,22 @@ static void construct_vsites_thread(ArrayRef<RVec>                  x,
             int inc = 1 + nra;
             int nr  = ilist[ftype].size();
 
-            const t_iatom* ia = ilist[ftype].iatoms.data();
+            int i = 0;
+#if GMX_SIMD_HAVE_REAL
+            /* The most common vsite type, used e.g. for TIP4P water, has a SIMD kernel */
+            if (ftype == F_VSITE3 && calculatePosition == VSiteCalculatePosition::Yes
+                && calculateVelocity == VSiteCalculateVelocity::No && pbc_null == nullptr)
+            {
+                constructVsite3Simd(x, ip, ilist[ftype], numVsite3SimdIatoms);
+                i = numVsite3SimdIatoms;
+            }
+#else
+            GMX_UNUSED_VALUE(numVsite3SimdIatoms);
+#endif
 
-            for (int i = 0; i < nr;)
+            const t_iatom* ia = ilist[ftype].iatoms.data() + i;
+
+            for (; i < nr;)
             {
                 int tp = ia[0];
                 /* The vsite and constructing atoms */
@@ -1139,6 +1280,8 @@ static void construct_vsites_thread(ArrayRef<RVec>                  x,
  * \param[in,out] v   When not empty, velocities are generated for virtual sites
  * \param[in]     ip  Interaction parameters for all interaction, only vsite parameters are used
  * \param[in]     ilist  The interaction lists, only vsites are usesd
+ * \param[in]     numVsite3SimdIatoms  The number of F_VSITE3 iatoms in \p ilist that can use SIMD,
+ *                                     only used without threading
  * \param[in]     domainInfo  Information about PBC and DD
  * \param[in]     box  Used for PBC when PBC is set in domainInfo
  */
@@ -1148,6 +1291,7 @@ static void construct_vsites(const ThreadingInfo*            threadingInfo,
                              ArrayRef<RVec>                  v,
                              ArrayRef<const t_iparams>       ip,
                              ArrayRef<const InteractionList> ilist,
+                             const int                       numVsite3SimdIatoms,
                              const DomainInfo&               domainInfo,
                              const matrix                    box)
 {
@@ -1187,7 +1331,8 @@ static void construct_vsites(const ThreadingInfo*            threadingInfo,
 
     if (threadingInfo == nullptr || threadingInfo->numThreads() == 1)
     {
-        construct_vsites_thread<calculatePosition, calculateVelocity>(x, v, ip, ilist, pbc_null);
+        construct_vsites_thread<calculatePosition, calculateVelocity>(
+                x, v, ip, ilist, numVsite3SimdIatoms, pbc_null);
     }
     else
     {
@@ -1201,22 +1346,24 @@ static void construct_vsites(const ThreadingInfo*            threadingInfo,
                            "The thread data should be initialized before calling construct_vsites");
 
                 construct_vsites_thread<calculatePosition, calculateVelocity>(
-                        x, v, ip, tData.ilist, pbc_null);
+                        x, v, ip, tData.ilist, tData.numVsite3SimdIatoms, pbc_null);
                 if (tData.useInterdependentTask)
                 {
+                    const InterdependentTask& idTask = tData.idTask;
                     /* Here we don't need a barrier (unlike the spreading),
                      * since both tasks only construct vsites from particles,
                      * or local vsites, not from non-local vsites.
                      */
                     construct_vsites_thread<calculatePosition, calculateVelocity>(
-                            x, v, ip, tData.idTask.ilist, pbc_null);
+                            x, v, ip, idTask.ilist, idTask.numVsite3SimdIatoms, pbc_null);
                 }
             }
             GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
         /* Now we can construct the vsites that might depend on other vsites */
+        const VsiteThread& tDataDependent = threadingInfo->threadDataNonLocalDependent();
         construct_vsites_thread<calculatePosition, calculateVelocity>(
-                x, v, ip, threadingInfo->threadDataNonLocalDependent().ilist, pbc_null);
+                x, v, ip, tDataDependent.ilist, tDataDependent.numVsite3SimdIatoms, pbc_null);
     }
 }
 
@@ -1229,15 +1376,36 @@ void VirtualSitesHandler::Impl::construct(ArrayRef<RVec> x,
     {
         case VSiteOperation::Positions:
             construct_vsites<VSiteCalculatePosition::Yes, VSiteCalculateVelocity::No>(
-                    &threadingInfo_, x, v, iparams_, ilists_, domainInfo_, box);
+                    &threadingInfo_,
+                    x,
+                    v,
+                    iparams_,
+                    ilists_,
+                    numVsite3SimdIatoms_,
+                    domainInfo_,
+                    box);
             break;
         case VSiteOperation::Velocities:
             construct_vsites<VSiteCalculatePosition::No, VSiteCalculateVelocity::Yes>(
-                    &threadingInfo_, x, v, iparams_, ilists_, domainInfo_, box);
+                    &threadingInfo_,
+                    x,
+                    v,
+                    iparams_,
+                    ilists_,
+                    numVsite3SimdIatoms_,
+                    domainInfo_,
+                    box);
             break;
         case VSiteOperation::PositionsAndVelocities:
             construct_vsites<VSiteCalculatePosition::Yes, VSiteCalculateVelocity::Yes>(
-                    &threadingInfo_, x, v, iparams_, ilists_, domainInfo_, box);
+                    &threadingInfo_,
+                    x,
+                    v,
+                    iparams_,
+                    ilists_,
+                    numVsite3SimdIatoms_,
+                    domainInfo_,
+                    box);
             break;
         default: gmx_fatal(FARGS, "Unknown virtual site operation");
     }
@@ -1254,7 +1422,14 @@ void constructVirtualSites(ArrayRef<RVec> x, ArrayRef<const t_iparams> ip, Array
     // No PBC, no DD
     const DomainInfo domainInfo;
     construct_vsites<VSiteCalculatePosition::Yes, VSiteCalculateVelocity::No>(
-            nullptr, x, {}, ip, ilist, domainInfo, nullptr);
+            nullptr,
+            x,
+            {},
+            ip,
+            ilist,
+            countVsite3SimdIatoms(ilist[F_VSITE3], x.ssize()),
+            domainInfo,
+            nullptr);
 }
 
 #ifndef DOXYGEN
@@ -3071,6 +3246,20 @@ void ThreadingInfo::setVirtualSites(ArrayRef<const InteractionList> ilists,
      */
     assignVsitesToSingleTask(tData_[numThreads_].get(), 2 * numThreads_, taskIndex_, ilists, iparams);
 
+    /* Determine which vsites can be constructed with SIMD, once per list change */
+#pragma omp parallel for num_threads(numThreads_) schedule(static)
+    for (int th = 0; th < numThreads_ + 1; th++)
+    {
+        try
+        {
+            VsiteThread& tData        = *tData_[th];
+            tData.numVsite3SimdIatoms = countVsite3SimdIatoms(tData.ilist[F_VSITE3], numAtoms);
+            tData.idTask.numVsite3SimdIatoms =
+                    countVsite3SimdIatoms(tData.idTask.ilist[F_VSITE3], numAtoms);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
     if (debug && numThreads_ > 1)
     {
         fprintf(debug,
@@ -3120,6 +3309,10 @@ void VirtualSitesHandler::Impl::setVirtualSites(ArrayRef<const InteractionList>
     ilists_ = ilists;
 
     threadingInfo_.setVirtualSites(ilists, iparams_, numAtoms, homenr, ptype, domainInfo_.useDomdec());
+    if (threadingInfo_.numThreads() == 1)
+    {
+        numVsite3SimdIatoms_ = countVsite3SimdIatoms(ilists[F_VSITE3], numAtoms);
+    }
 }
 
 void VirtualSitesHandler::setVirtualSites(ArrayRef<const InteractionList> ilists,
@@ -2410,6 +2410,7 @@ int Mdrunner::mdrunner()
         // Pinned buffers are associated with contexts in CUDA.
         // As soon as we destroy GPU contexts after mdrunner() exits, these lines should go.
         cr->destroyDD();
+        gmx_done_nodecomm(cr);
         mdAtoms.reset(nullptr);
         globalState.reset(nullptr);
         localStateInstance.reset(nullptr);
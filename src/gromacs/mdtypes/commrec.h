@@ -67,6 +67,22 @@ struct gmx_nodecomm_t
     MPI_Comm comm_intra = MPI_COMM_NULL;
     int      rank_intra = 0;
     MPI_Comm comm_inter = MPI_COMM_NULL;
+    //! The number of ranks in comm_intra
+    int size_intra = 1;
+    //! The number of nodes, i.e. the size of comm_inter for intra-node rank 0
+    int numNodes = 1;
+#if GMX_LIB_MPI && MPI_VERSION >= 3
+    //! MPI-3 shared-memory window used for summing double buffers within the node
+    MPI_Win sharedWindow = MPI_WIN_NULL;
+#endif
+    /*! \brief Pointer to the node-shared summation buffer, nullptr when not in use
+     *
+     * Consists of size_intra input slots followed by one result slot,
+     * each of sharedBufferSlotSize elements.
+     */
+    double* sharedBuffer = nullptr;
+    //! The number of doubles per slot in sharedBuffer
+    std::size_t sharedBufferSlotSize = 0;
 };
 
 struct t_commrec
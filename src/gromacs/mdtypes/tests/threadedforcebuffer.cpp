@@ -0,0 +1,149 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright 2025- The GROMACS Authors
+ * and the project initiators Erik Lindahl, Berk Hess and David van der Spoel.
+ * Consult the AUTHORS/COPYING files and https://www.gromacs.org for details.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * https://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at https://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out https://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the ThreadedForceBuffer class.
+ *
+ * \ingroup module_mdtypes
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdtypes/threaded_force_buffer.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/utility/arrayref.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of thread buffers to test with
+constexpr int c_numThreads = 4;
+//! The number of atoms, not a multiple of the reduction block size
+constexpr int c_numAtoms = 150;
+
+//! Returns whether thread \p t writes to atom \p a, this gives blocks with varying thread counts
+bool threadWritesAtom(int t, int a)
+{
+    return (a / 7) % (t + 2) == 0;
+}
+
+//! Returns the force thread \p t adds to atom \p a, values are exactly representable
+real forceComponent(int t, int a, int d)
+{
+    return static_cast<real>(1 + t + 2 * a + 3 * d);
+}
+
+//! Fills the thread buffers, reduces them and checks the result
+template<typename ForceBufferElementType>
+void checkReduction()
+{
+    ThreadedForceBuffer<ForceBufferElementType> threadedForceBuffer(c_numThreads, false, 1);
+
+    for (int t = 0; t < c_numThreads; t++)
+    {
+        auto& threadForceBuffer = threadedForceBuffer.threadForceBuffer(t);
+        threadForceBuffer.resizeBufferAndClearMask(c_numAtoms);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            if (threadWritesAtom(t, a))
+            {
+                threadForceBuffer.addAtomToMask(a);
+            }
+        }
+        threadForceBuffer.processMask();
+        threadForceBuffer.clearForcesAndEnergies();
+        auto forceBuffer = threadForceBuffer.forceBuffer();
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            if (threadWritesAtom(t, a))
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    forceBuffer[a][d] = forceComponent(t, a, d);
+                }
+            }
+        }
+    }
+    threadedForceBuffer.setupReduction();
+
+    PaddedVector<RVec>   force(c_numAtoms, { 0.0_real, 0.0_real, 0.0_real });
+    std::vector<RVec>    shiftForces(c_numShiftVectors, { 0.0_real, 0.0_real, 0.0_real });
+    ForceWithShiftForces forceWithShiftForces(force.arrayRefWithPadding(), false, shiftForces);
+    StepWorkload         stepWork;
+    stepWork.computeForces = true;
+
+    threadedForceBuffer.reduce(&forceWithShiftForces, nullptr, nullptr, {}, stepWork, 0);
+
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            real reference = 0;
+            for (int t = 0; t < c_numThreads; t++)
+            {
+                if (threadWritesAtom(t, a))
+                {
+                    reference += forceComponent(t, a, d);
+                }
+            }
+            EXPECT_EQ(force[a][d], reference) << "atom " << a << " dim " << d;
+        }
+    }
+}
+
+TEST(ThreadedForceBuffer, ReducesSparseRVecBuffers)
+{
+    checkReduction<RVec>();
+}
+
+TEST(ThreadedForceBuffer, ReducesSparseRVec4Buffers)
+{
+    checkReduction<rvec4>();
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -149,17 +149,43 @@ void ThreadForceBuffer<ForceBufferElementType>::processMask()
 namespace
 {
 
+/*! \brief Adds the atom range \p a0 to \p a1 of force buffer \p fp to \p f
+ *
+ * For RVec buffers the range is contiguous in memory in both arrays,
+ * so we can loop over reals, which lets the compiler vectorize the loop.
+ */
+template<typename ForceBufferElementType>
+inline void addForceBufferRange(rvec* gmx_restrict                         f,
+                                const ForceBufferElementType* gmx_restrict fp,
+                                int                                        a0,
+                                int                                        a1)
+{
+    if constexpr (sizeof(ForceBufferElementType) == sizeof(rvec))
+    {
+        real* gmx_restrict       fReal  = f[0];
+        const real* gmx_restrict fpReal = fp[0];
+        for (int i = a0 * DIM; i < a1 * DIM; i++)
+        {
+            fReal[i] += fpReal[i];
+        }
+    }
+    else
+    {
+        for (int a = a0; a < a1; a++)
+        {
+            rvec_inc(f[a], fp[a]);
+        }
+    }
+}
+
 //! \brief Reduce thread-local force buffers into \p force (does not reduce shift forces)
 template<typename ForceBufferElementType>
 void reduceThreadForceBuffers(ArrayRef<gmx::RVec> force,
                               ArrayRef<std::unique_ptr<ThreadForceBuffer<ForceBufferElementType>>> threadForceBuffers,
-                              ArrayRef<const gmx_bitmask_t> masks,
-                              ArrayRef<const int>           usedBlockIndices)
+                              ArrayRef<const int> usedBlockIndices,
+                              ArrayRef<const int> usedBlockBufferStart,
+                              ArrayRef<const int> usedBlockBufferIndices)
 {
-    const int numBuffers = threadForceBuffers.size();
-    GMX_ASSERT(numBuffers <= s_maxNumThreadsForReduction,
-               "There is a limit on the number of buffers we can use for reduction");
-
     const int numAtoms = threadForceBuffers[0]->size();
 
     rvec* gmx_restrict f = as_rvec_array(force.data());
@@ -183,46 +209,23 @@ void reduceThreadForceBuffers(ArrayRef<gmx::RVec> force,
     {
         try
         {
-            // Reduce the buffers that contribute to this block
-            ForceBufferElementType* fp[s_maxNumThreadsForReduction];
-
             const int blockIndex = usedBlockIndices[b];
 
-            // Make a list of threads that have this block index set in the mask
-            int numContributingBuffers = 0;
-            for (int ft = 0; ft < numBuffers; ft++)
-            {
-                if (bitmask_is_set(masks[blockIndex], ft))
-                {
-                    fp[numContributingBuffers++] =
-                            threadForceBuffers[ft]->forceBufferWithPadding().paddedArrayRef().data();
-                }
-            }
-            if (numContributingBuffers > 0)
+            int a0 = blockIndex * ThreadForceBuffer<ForceBufferElementType>::s_reductionBlockSize;
+            int a1 = (blockIndex + 1) * ThreadForceBuffer<ForceBufferElementType>::s_reductionBlockSize;
+            // Note: It would be nice if we could pad f to avoid this min()
+            a1 = std::min(a1, numAtoms);
+
+            /* Reduce only the buffers that contribute to this block, the list
+             * is precomputed in setupReduction(). We loop over the buffers
+             * in the outer loop, which keeps the summation order per atom
+             * identical to looping over buffers for each atom.
+             */
+            for (int i = usedBlockBufferStart[b]; i < usedBlockBufferStart[b + 1]; i++)
             {
-                // Reduce the selected buffers
-                int a0 = blockIndex * ThreadForceBuffer<ForceBufferElementType>::s_reductionBlockSize;
-                int a1 = (blockIndex + 1) * ThreadForceBuffer<ForceBufferElementType>::s_reductionBlockSize;
-                // Note: It would be nice if we could pad f to avoid this min()
-                a1 = std::min(a1, numAtoms);
-                if (numContributingBuffers == 1)
-                {
-                    // Avoid double loop for the case of a single buffer
-                    for (int a = a0; a < a1; a++)
-                    {
-                        rvec_inc(f[a], fp[0][a]);
-                    }
-                }
-                else
-                {
-                    for (int a = a0; a < a1; a++)
-                    {
-                        for (int fb = 0; fb < numContributingBuffers; fb++)
-                        {
-                            rvec_inc(f[a], fp[fb][a]);
-                        }
-                    }
-                }
+                const ForceBufferElementType* fp =
+                        threadForceBuffers[usedBlockBufferIndices[i]]->forceBufferWithPadding().paddedArrayRef().data();
+                addForceBufferRange(f, fp, a0, a1);
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
@@ -274,11 +277,17 @@ void ThreadedForceBuffer<ForceBufferElementType>::setupReduction()
     }
 
     /* Reduce the masks over the threads and determine which blocks
-     * we need to reduce over.
+     * we need to reduce over and which buffers contribute to each block.
      */
+    GMX_RELEASE_ASSERT(numBuffers <= s_maxNumThreadsForReduction,
+                       "There is a limit on the number of buffers we can use for reduction");
+
     reductionMask_.resize(totalNumBlocks);
 
     usedBlockIndices_.clear();
+    usedBlockBufferStart_.clear();
+    usedBlockBufferIndices_.clear();
+    usedBlockBufferStart_.push_back(0);
     int numBlocksUsed = 0;
     for (int b = 0; b < totalNumBlocks; b++)
     {
@@ -293,6 +302,14 @@ void ThreadedForceBuffer<ForceBufferElementType>::setupReduction()
         if (!bitmask_is_zero(mask))
         {
             usedBlockIndices_.push_back(b);
+            for (int t = 0; t < numBuffers; t++)
+            {
+                if (bitmask_is_set(mask, t))
+                {
+                    usedBlockBufferIndices_.push_back(t);
+                }
+            }
+            usedBlockBufferStart_.push_back(usedBlockBufferIndices_.size());
         }
 
         if (debug)
@@ -340,8 +357,11 @@ void ThreadedForceBuffer<ForceBufferElementType>::reduce(gmx::ForceWithShiftForc
         /* Reduce the force buffer */
         GMX_ASSERT(forceWithShiftForces, "Need a valid force buffer for reduction");
 
-        reduceThreadForceBuffers<ForceBufferElementType>(
-                forceWithShiftForces->force(), threadForceBuffers_, reductionMask_, usedBlockIndices_);
+        reduceThreadForceBuffers<ForceBufferElementType>(forceWithShiftForces->force(),
+                                                         threadForceBuffers_,
+                                                         usedBlockIndices_,
+                                                         usedBlockBufferStart_,
+                                                         usedBlockBufferIndices_);
     }
 
     const int numBuffers = numThreadBuffers();
@@ -235,6 +235,10 @@ private:
     std::vector<std::unique_ptr<ThreadForceBuffer<ForceBufferElementType>>> threadForceBuffers_;
     //! Indices of blocks that are used, i.e. have force contributions.
     std::vector<int> usedBlockIndices_;
+    //! For each used block, the start of its buffers in usedBlockBufferIndices_, plus the end
+    std::vector<int> usedBlockBufferStart_;
+    //! Indices of the buffers that contribute to each used block, concatenated over the used blocks
+    std::vector<int> usedBlockBufferIndices_;
     //! Mask array, one element corresponds to a block of reduction_block_size atoms of the force array, bit corresponding to thread indices set if a thread writes to that block
     std::vector<gmx_bitmask_t> reductionMask_;
 
@@ -54,6 +54,7 @@
 #include "gromacs/mdtypes/pullhistory.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/modularsimulator/modularsimulatorinterfaces.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -127,8 +128,12 @@ void CheckpointHelper::writeCheckpoint(Step step, Time time)
 
     if (MAIN(cr_))
     {
+        /* Time the checkpoint writing as trajectory output, as the legacy simulator does */
+        gmx_wallcycle* wcycle = mdoutf_get_wcycle(trajectoryElement_->outf_);
+        wallcycle_start(wcycle, WallCycleCounter::Traj);
         mdoutf_write_checkpoint(
                 trajectoryElement_->outf_, fplog_, cr_, step, time, state_global_, observablesHistory_, &checkpointDataHolder);
+        wallcycle_stop(wcycle, WallCycleCounter::Traj);
     }
 }
 
@@ -106,6 +106,8 @@ enum class WallCycleCounter : int
     PullPot,
     Awh,
     Traj,
+    TrajWriterWait,
+    CheckpointWait,
     Update,
     Constr,
     MoveE,
@@ -226,6 +228,8 @@ static const char* enumValuetoString(WallCycleCounter enumValue)
         "COM pull force",
         "AWH",
         "Write traj.",
+        "Wait traj. writer",
+        "Wait checkpoint",
         "Update",
         "Constraints",
         "Comm. energies",
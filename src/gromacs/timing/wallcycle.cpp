@@ -386,6 +386,9 @@ WallcycleCounts wallcycle_sum(const t_commrec* cr, gmx_wallcycle* wc)
 
     subtract_cycles(wcc, WallCycleCounter::PmeFft, WallCycleCounter::PmeFftComm);
 
+    subtract_cycles(wcc, WallCycleCounter::Traj, WallCycleCounter::TrajWriterWait);
+    subtract_cycles(wcc, WallCycleCounter::Traj, WallCycleCounter::CheckpointWait);
+
     if (cr->npmenodes == 0)
     {
         /* All nodes do PME (or no PME at all) */
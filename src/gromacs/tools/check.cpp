@@ -790,7 +790,11 @@ int gmx_check(int argc, char* argv[])
         "Similarly a pair of trajectory files can be compared (using the [TT]-f2[tt]",
         "option), or a pair of energy files (using the [TT]-e2[tt] option).[PAR]",
         "For free energy simulations the A and B state topology from one",
-        "run input file can be compared with options [TT]-s1[tt] and [TT]-ab[tt].[PAR]"
+        "run input file can be compared with options [TT]-s1[tt] and [TT]-ab[tt].[PAR]",
+        "Option [TT]-xtcindex[tt] writes a frame index for the [REF].xtc[ref] file given",
+        "with [TT]-f[tt], named after the trajectory with [TT].idx[tt] appended.",
+        "Tools that read the trajectory use the index to skip frames excluded with",
+        "[TT]-b[tt] or [TT]-dt[tt] without decompressing them."
     };
     t_filenm fnm[] = { { efTRX, "-f", nullptr, ffOPTRD },  { efTRX, "-f2", nullptr, ffOPTRD },
                        { efTPR, "-s1", "top1", ffOPTRD },  { efTPR, "-s2", "top2", ffOPTRD },
@@ -809,6 +813,7 @@ int gmx_check(int argc, char* argv[])
     real              abstol   = 0.001;
     gmx_bool          bCompAB  = FALSE;
     char*             lastener = nullptr;
+    gmx_bool          bXtcIdx  = FALSE;
     t_pargs           pa[]     = {
         { "-vdwfac",
           FALSE,
@@ -835,7 +840,12 @@ int gmx_check(int argc, char* argv[])
           etSTR,
           { &lastener },
           "Last energy term to compare (if not given all are tested). It makes sense to go up "
-          "until the Pressure." }
+          "until the Pressure." },
+        { "-xtcindex",
+          FALSE,
+          etBOOL,
+          { &bXtcIdx },
+          "Write a frame index for the XTC file given with -f" }
     };
 
     if (!parse_common_args(&argc, argv, 0, NFILE, fnm, asize(pa), pa, asize(desc), desc, 0, nullptr, &oenv))
@@ -865,6 +875,18 @@ int gmx_check(int argc, char* argv[])
     {
         fprintf(stderr, "Please give me TWO trajectory (.xtc/.trr/.tng) files!\n");
     }
+    if (bXtcIdx)
+    {
+        if (fn1 && fn2ftp(fn1) == efXTC)
+        {
+            generate_xtc_frame_index(fn1);
+            fprintf(stderr, "Wrote frame index %s\n", xtc_frame_index_filename(fn1).string().c_str());
+        }
+        else
+        {
+            fprintf(stderr, "Option -xtcindex needs an XTC file given with -f\n");
+        }
+    }
     output_env_done(oenv);
 
     fn1 = opt2fn_null("-s1", NFILE, fnm);
@@ -178,6 +178,27 @@ static inline real mtopGetAtomMass(const gmx_mtop_t& mtop, int globalAtomIndex,
     return atom.m;
 }
 
+/*! \brief Returns the charge of an atom based on global atom index
+ *
+ * Returns the A-state charge of the atom with global index \p globalAtomIndex.
+ * The atom index has to be in range: 0 <= \p globalAtomIndex < \p mtop->natoms.
+ * The input value of moleculeBlock should be in range. Use 0 as starting value.
+ * For subsequent calls to this function, e.g. in a loop, pass in the previously
+ * returned value for best performance. Atoms in a group tend to be in the same
+ * molecule(block), so this minimizes the search time.
+ *
+ * \param[in]     mtop                 The molecule topology
+ * \param[in]     globalAtomIndex      The global atom index to look up
+ * \param[in,out] moleculeBlock        The molecule block index in \p mtop
+ */
+static inline real mtopGetAtomCharge(const gmx_mtop_t& mtop,
+                                     int               globalAtomIndex,
+                                     int*              moleculeBlock)
+{
+    const t_atom& atom = mtopGetAtomParameters(mtop, globalAtomIndex, moleculeBlock);
+    return atom.q;
+}
+
 /*! \brief Look up the atom and residue name and residue number and index of a global atom index
  *
  * The atom index has to be in range: 0 <= \p globalAtomIndex < \p mtop->natoms.
@@ -53,6 +53,7 @@
 #include "gromacs/topology/idef.h"
 #include "gromacs/topology/ifunc.h"
 #include "gromacs/topology/mtop_atomloops.h"
+#include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/basedefinitions.h"
@@ -155,6 +156,38 @@ TEST(MtopTest, Operators)
     done_atom(&mtop.moltype[0].atoms);
 }
 
+TEST(MtopTest, LooksUpAtomParametersByGlobalIndex)
+{
+    gmx_mtop_t mtop;
+    addNWaterMolecules(&mtop, 2);
+    for (int i = 0; i < mtop.moltype[0].atoms.nr; i++)
+    {
+        mtop.moltype[0].atoms.atom[i].q = (i == 0) ? -0.8 : 0.4;
+    }
+    // A second block of the same molecule type, so lookups need to search the blocks
+    mtop.molblock.emplace_back();
+    mtop.molblock.back().type = 0;
+    mtop.molblock.back().nmol = 3;
+    mtop.natoms += 3 * mtop.moltype[0].atoms.nr;
+    mtop.finalize();
+
+    int moleculeBlock = 0;
+    for (int i = 0; i < mtop.natoms; i++)
+    {
+        const t_atom& atom = mtop.moltype[0].atoms.atom[i % 3];
+        EXPECT_EQ(mtopGetAtomMass(mtop, i, &moleculeBlock), atom.m);
+        EXPECT_EQ(mtopGetAtomCharge(mtop, i, &moleculeBlock), atom.q);
+    }
+    EXPECT_EQ(moleculeBlock, 1);
+    // Searching backwards from the last block should also work
+    for (int i = mtop.natoms - 1; i >= 0; i--)
+    {
+        EXPECT_EQ(mtopGetAtomCharge(mtop, i, &moleculeBlock), mtop.moltype[0].atoms.atom[i % 3].q);
+    }
+    EXPECT_EQ(moleculeBlock, 0);
+    done_atom(&mtop.moltype[0].atoms);
+}
+
 TEST(MtopTest, CanFindResidueStartAndEndAtoms)
 {
     gmx_mtop_t mtop;